@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Benchmark
+#
+# Run each program's benchmark build (NAME-bench.prg) in VICE without a
+# window, and report its count of work done per emulated second.
+#
+# Programs built with -DBENCH print "name unit count tenths jiffies" to
+# the printer on device 4, which VICE writes to a text file, then exit VICE
+# through the debug cartridge. The cycle limit only stops a program that
+# never finishes.
+#
+# The start column is the time from power on to the program's first frame.
+# With DISK=1, each PRG (and its packed version, NAME-bench-packed.prg) is
+# loaded from a 1541 disk image with true drive emulation, so start shows
+# the load time.
+#
+# usage: bench.sh DIR...
+#
+# environment:
+#   X64        VICE emulator (default: x64sc)
+#   C1541      VICE disk image tool (default: c1541)
+#   VICEFLAGS  extra VICE options
+#   LIMIT      cycle limit per program (default: 120 seconds of PAL cycles)
+#   REPORT     report file (default: bench-report.txt)
+#   DISK       load from a disk image (default: 0)
+
+X64=${X64:-x64sc}
+C1541=${C1541:-c1541}
+LIMIT=${LIMIT:-$((985248 * 120))}
+REPORT=${REPORT:-bench-report.txt}
+DISK=${DISK:-0}
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+printf '%-18s %-12s %10s %8s %10s %7s\n' \
+    program unit count seconds per-second start > "$REPORT"
+for dir in "$@"; do
+    for prg in "$dir"/*-bench.prg "$dir"/*-bench-packed.prg; do
+        [ -f "$prg" ] || continue
+        name=$(basename "$prg" .prg | sed 's/-bench//')
+        out="$tmp/printer.txt"
+        rm -f "$out"
+
+        if [ "$DISK" = 1 ]; then
+            rm -f "$tmp/bench.d64"
+            "$C1541" -format bench,00 d64 "$tmp/bench.d64" \
+                -write "$prg" "$name" > /dev/null 2>&1
+            start="-drive8truedrive -drive8type 1541 -autostart $tmp/bench.d64:$name"
+        else
+            start="-autostart $prg"
+        fi
+
+        "$X64" -default -console -warp -debugcart -sounddev dummy \
+            -limitcycles "$LIMIT" \
+            -device4 1 -pr4drv raw -pr4output text -pr4txtdev 0 -prtxtdev1 "$out" \
+            $VICEFLAGS $start > "$tmp/vice.log" 2>&1
+
+        # printer text is PETSCII: carriage returns, and lowercase as uppercase
+        line=$(tr '\r' '\n' < "$out" 2>/dev/null | tr 'A-Z' 'a-z' | grep . | tail -n 1)
+        if [ -z "$line" ]; then
+            printf '%-18s %-12s %10s\n' "$name" - timeout >> "$REPORT"
+            continue
+        fi
+        echo "$line" | awk -v name="$name" '{
+            printf "%-18s %-12s %10d %8.1f %10.2f %7.1f\n", name, $2, $3, $4 / 10,
+                   ($4 > 0) ? $3 * 10 / $4 : 0, $5 / 60 }' >> "$REPORT"
+    done
+done
+cat "$REPORT"
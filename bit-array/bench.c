@@ -0,0 +1,97 @@
+/**
+ * Benchmark
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifdef BENCH
+
+#include <c64.h>
+#include <cbm.h>
+#include <peekpoke.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define BENCH_LFN    4                  // printer logical file number
+#define BENCH_DEVICE 4                  // printer device
+#define DEBUG_CART   0xd7ff             // VICE debug cartridge exit register
+
+// convert BCD time of day register to binary
+#define FROM_BCD(b) (((b) >> 4) * 10 + ((b) & 0x0f))
+
+unsigned long bench_count;
+static unsigned long bench_jiffies;
+
+void bench_start(void)
+{
+    bench_count = 0;
+    bench_jiffies = ((unsigned long)PEEK(0xa0) << 16) | (PEEK(0xa1) << 8) | PEEK(0xa2);
+
+    // run the time of day clock from the mains frequency for this machine
+    if (get_tv() == TV_PAL)
+        CIA1.cra |= 0x80;
+    else
+        CIA1.cra &= 0x7f;
+
+    // writing hours stops the clock, writing tenths starts it
+    CIA1.tod_hour = 0;
+    CIA1.tod_min = 0;
+    CIA1.tod_sec = 0;
+    CIA1.tod_10 = 0;
+}
+
+unsigned bench_tenths(void)
+{
+    unsigned char min, sec, tenths;
+
+    // reading hours latches the clock, reading tenths releases it
+    asm("lda $dc0b");
+    min = CIA1.tod_min;
+    sec = CIA1.tod_sec;
+    tenths = CIA1.tod_10;
+    return ((unsigned)FROM_BCD(min) * 60 + FROM_BCD(sec)) * 10 + tenths;
+}
+
+unsigned char bench_done(void)
+{
+    return bench_tenths() >= BENCH_SECONDS * 10;
+}
+
+static void bench_puts(const char *s)
+{
+    cbm_write(BENCH_LFN, s, strlen(s));
+}
+
+void bench_report(const char *name, const char *unit)
+{
+    char buf[12];
+    unsigned tenths = bench_tenths();
+
+    // keep result where a monitor can find it
+    *(unsigned long *)BENCH_RESULT = bench_count;
+    *(unsigned *)(BENCH_RESULT + 4) = tenths;
+    *(unsigned long *)(BENCH_RESULT + 6) = bench_jiffies;
+
+    // one line to the printer
+    if (cbm_open(BENCH_LFN, BENCH_DEVICE, 0, "") == 0) {
+        bench_puts(name);
+        bench_puts(" ");
+        bench_puts(unit);
+        bench_puts(" ");
+        bench_puts(ultoa(bench_count, buf, 10));
+        bench_puts(" ");
+        bench_puts(utoa(tenths, buf, 10));
+        bench_puts(" ");
+        bench_puts(ultoa(bench_jiffies, buf, 10));
+        bench_puts("\r");
+        cbm_close(BENCH_LFN);
+    }
+
+    // exit VICE (a write to an unused SID mirror on real hardware)
+    POKE(DEBUG_CART, 0);
+}
+
+#endif
@@ -3,9 +3,14 @@
  */
 
 #include <cbm.h>
-#include <stdio.h>
 #include <stdlib.h>
 
+#include "console.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
+
 #define TRUE       1
 #define FALSE      0
 #define X_SIZE     320
@@ -50,23 +55,23 @@ void bit_test()
 {
     byte b;
 
-    printf("\nbit test\n\n");
+    con_printf("\nbit test\n\n");
 
     b = 0;
-    printf("add even bits: %d", b);
+    con_printf("add even bits: %d", b);
     b |= 1 << 2;
-    printf(" -> %d", b);
+    con_printf(" -> %d", b);
     b |= 1 << 4;
-    printf(" -> %d", b);
+    con_printf(" -> %d", b);
     b |= 1 << 6;
-    printf(" -> %d\n", b);
-    printf("remove even bits: %d", b);
+    con_printf(" -> %d\n", b);
+    con_printf("remove even bits: %d", b);
     b &= ~(1 << 2);
-    printf(" -> %d", b);
+    con_printf(" -> %d", b);
     b &= ~(1 << 4);
-    printf(" -> %d", b);
+    con_printf(" -> %d", b);
     b &= ~(1 << 6);
-    printf(" -> %d\n", b);
+    con_printf(" -> %d\n", b);
 }
 
 void bit_array_test()
@@ -74,69 +79,69 @@ void bit_array_test()
     ushort p;
     short x, y;
 
-    printf("\nbit array test\n\n");
+    con_printf("\nbit array test\n\n");
 
     p = 14405;
     set_bit_pos(p, TRUE);
     if (get_bit_pos(p) != TRUE)
-        printf("error: ");
-    printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
+        con_printf("error: ");
+    con_printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
     set_bit_pos(p, FALSE);
     if (get_bit_pos(p) != FALSE)
-        printf("error: ");
-    printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
+        con_printf("error: ");
+    con_printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
 
     p = 60810;
     set_bit_pos(p, TRUE);
     if (get_bit_pos(p) != TRUE)
-        printf("error: ");
-    printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
+        con_printf("error: ");
+    con_printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
     set_bit_pos(p, FALSE);
     if (get_bit_pos(p) != FALSE)
-        printf("error: ");
-    printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
+        con_printf("error: ");
+    con_printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
 
     x = 10;
     y = 90;
     set_bit_xy(x, y, TRUE);
     if (get_bit_xy(x, y) != TRUE)
-        printf("error: ");
-    printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
+        con_printf("error: ");
+    con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
     set_bit_xy(x, y, FALSE);
     if (get_bit_xy(x, y) != FALSE)
-        printf("error: ");
-    printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
+        con_printf("error: ");
+    con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
 
     x = 10;
     y = 190;
     set_bit_xy(x, y, TRUE);
     if (get_bit_xy(x, y) != TRUE)
-        printf("error: ");
-    printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
+        con_printf("error: ");
+    con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
     set_bit_xy(x, y, FALSE);
     if (get_bit_xy(x, y) != FALSE)
-        printf("error: ");
-    printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
+        con_printf("error: ");
+    con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
 }
 
 bit_array_test_pos()
 {
     ushort p;
 
-    printf("\nbit array test: pos\n\n");
+    con_printf("\nbit array test: pos\n\n");
 
     for (p = 0; p < ARRAY_SIZE; p += 1000) {
         set_bit_pos(p, TRUE);
         if (get_bit_pos(p) != TRUE)
-            printf("error: ");
-        printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
+            con_printf("error: ");
+        con_printf("pos: %5u, set: %d, get: %d\n", p, TRUE, get_bit_pos(p));
     }
 
     for (p = 0; p < ARRAY_SIZE; p += 1000) {
         set_bit_pos(p, FALSE);
         if (get_bit_pos(p) != FALSE)
-            printf("error: ");
-        printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
+            con_printf("error: ");
+        con_printf("pos: %5u, set: %d, get: %d\n", p, FALSE, get_bit_pos(p));
     }
 }
 
@@ -144,14 +149,14 @@ bit_array_test_xy()
 {
     short x, y;
 
-    printf("\nbit array test: xy\n\n");
+    con_printf("\nbit array test: xy\n\n");
 
     for (y = 0; y < Y_SIZE; y += 10) {
         for (x = 0; x < X_SIZE; x += 120) {
             set_bit_xy(x, y, TRUE);
             if (get_bit_xy(x, y) != TRUE)
-                printf("error: ");
-            printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
+                con_printf("error: ");
+            con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, TRUE, get_bit_xy(x, y));
         }
     }
 
@@ -159,14 +164,18 @@ bit_array_test_xy()
         for (x = 0; x < X_SIZE; x += 120) {
             set_bit_xy(x, y, FALSE);
             if (get_bit_xy(x, y) != FALSE)
-                printf("error: ");
-            printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
+                con_printf("error: ");
+            con_printf("x,y: %3d,%3d, set: %d, get: %d\n", x, y, FALSE, get_bit_xy(x, y));
         }
     }
 }
 
 int main(void)
 {
+#ifdef BENCH
+    bench_start();
+#endif
+
     cbm_k_bsout(CH_FONT_UPPER);
 
     bit_test();
@@ -174,5 +183,10 @@ int main(void)
     bit_array_test_pos();
     bit_array_test_xy();
 
+#ifdef BENCH
+    BENCH_COUNT();
+    bench_report("bitarray", "runs");
+#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,159 @@
+/**
+ * Console
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef CONSOLE_STDIO
+
+#include <c64.h>
+#include <peekpoke.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "console.h"
+
+#define SCREEN_PAGE  0x0288             // KERNAL: high byte of screen RAM
+#define CURSOR_COLOR 0x0286             // KERNAL: text color
+#define CURSOR_ROW   0x00d6             // KERNAL: cursor row
+#define LINE_LINKS   0x00d9             // KERNAL: screen line link table
+#define COLUMNS      40
+#define ROWS         25
+#define BLANK        0x20               // screen code of a space
+
+// screen RAM, and the start of the cursor's row in it
+static unsigned char *screen;
+static unsigned char *line;
+
+// cursor (global for the asm in con_done)
+unsigned char con_row, con_col;
+
+// what to add to PETSCII to get screen codes, by the top three bits
+static const unsigned char to_screen[8] = {
+    0x00, 0x00, 0xc0, 0xe0, 0x00, 0xc0, 0x80, 0x80
+};
+
+static void newline(void)
+{
+    con_col = 0;
+    if (con_row < ROWS - 1) {
+        ++con_row;
+        line += COLUMNS;
+    } else {
+        // scroll up a row
+        memmove(screen, screen + COLUMNS, COLUMNS * (ROWS - 1));
+        memset(line, BLANK, COLUMNS);
+    }
+}
+
+void con_init(void)
+{
+    screen = (unsigned char *)(PEEK(SCREEN_PAGE) << 8);
+    con_row = PEEK(CURSOR_ROW);
+    con_col = 0;
+    line = screen + con_row * COLUMNS;
+    // one color for everything, so color RAM never needs scrolling
+    memset(COLOR_RAM, PEEK(CURSOR_COLOR), COLUMNS * ROWS);
+}
+
+void con_done(void)
+{
+    unsigned char i;
+
+    // every row starts a logical line, as after a clear screen
+    for (i = 0; i < ROWS; i++)
+        POKE(LINE_LINKS + i, ((unsigned)(screen + i * COLUMNS) >> 8) | 0x80);
+
+    // KERNAL PLOT (carry clear) moves the cursor
+    asm("ldx %v", con_row);
+    asm("ldy %v", con_col);
+    asm("clc");
+    asm("jsr $fff0");
+}
+
+void __fastcall__ con_putc(char c)
+{
+    unsigned char p = c;
+
+    if (c == '\n') {
+        newline();
+        return;
+    }
+    // other control codes do nothing
+    if (!(p & 0x60)) return;
+    line[con_col] = p + to_screen[p >> 5];
+    if (++con_col == COLUMNS) newline();
+}
+
+void __fastcall__ con_puts(const char *s)
+{
+    while (*s)
+        con_putc(*s++);
+}
+
+void con_printf(const char *format, ...)
+{
+    va_list ap;
+    char buf[8];
+    const char *s;
+    unsigned char width, len;
+    char c, pad;
+
+    va_start(ap, format);
+    while ((c = *format++) != 0) {
+        if (c != '%') {
+            con_putc(c);
+            continue;
+        }
+
+        // width, padded with spaces or zeros
+        pad = ' ';
+        if (*format == '0') {
+            pad = '0';
+            ++format;
+        }
+        width = 0;
+        while (*format >= '0' && *format <= '9')
+            width = width * 10 + *format++ - '0';
+
+        switch (c = *format++) {
+            case 'c':
+                buf[0] = va_arg(ap, int);
+                buf[1] = 0;
+                s = buf;
+                break;
+            case 's':
+                s = va_arg(ap, const char *);
+                break;
+            case 'd':
+                s = itoa(va_arg(ap, int), buf, 10);
+                break;
+            case 'u':
+                s = utoa(va_arg(ap, unsigned), buf, 10);
+                break;
+            case 0:
+                // % at the end
+                --format;
+                continue;
+            default:
+                // %% (and anything unknown) prints itself
+                buf[0] = c;
+                buf[1] = 0;
+                s = buf;
+                break;
+        }
+
+        len = strlen(s);
+        // sign before the zeros
+        if (pad == '0' && *s == '-')
+            con_putc(*s++);
+        for (; len < width; len++)
+            con_putc(pad);
+        con_puts(s);
+    }
+    va_end(ap);
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * Console
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * Text output written straight to screen RAM, for the console programs, in
+ * place of stdio and the KERNAL screen editor. With crt0.s in place of the
+ * cc65 startup, a program that only prints text links in little more than
+ * itself. con_printf knows %c, %s, %d, %u and %% (with a width, and 0 to
+ * pad with zeros), but no longs or hex.
+ *
+ * Build with -DCONSOLE_STDIO (and without crt0.s) to use printf and the
+ * usual startup instead, to compare the two.
+ */
+
+#ifndef _CONSOLE_H
+#define _CONSOLE_H
+
+#ifdef CONSOLE_STDIO
+
+#include <stdio.h>
+
+#define con_init()
+#define con_done()
+#define con_putc(c) putchar(c)
+#define con_puts(s) fputs((s), stdout)
+#define con_printf printf
+
+#else
+
+///// FUNCTIONS /////
+
+// start at the cursor's row, in the cursor color (called by crt0.s)
+void con_init(void);
+
+// hand the cursor back to the KERNAL (called by crt0.s)
+void con_done(void);
+
+// write a character, or move to the next line on '\n'
+void __fastcall__ con_putc(char c);
+
+// write a string
+void __fastcall__ con_puts(const char *s);
+
+// write formatted text
+void con_printf(const char *format, ...);
+
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+;
+; Minimal startup code for the console programs (in place of the cc65 c64
+; crt0)
+;
+; It exports __STARTUP__, so the linker takes it instead of the library's.
+; Unlike that one it does not switch to the lower case character set, pass
+; command line arguments, or set up the KERNAL screen editor for conio and
+; stdio: it saves what the C runtime uses, calls con_init and main, and
+; puts it back. Library constructors and destructors are still run, though
+; a program using console.c alone has none.
+;
+
+        .export         _exit
+        .export         __STARTUP__ : absolute = 1
+        .import         initlib, donelib, zerobss
+        .import         _main, _con_init, _con_done
+        .import         __MAIN_START__, __MAIN_SIZE__
+
+        .include        "zeropage.inc"
+
+STATUS  = $90                   ; KERNAL I/O status, BASIC's ST
+
+.segment        "STARTUP"
+
+; Bank out BASIC (the C stack is at the top of RAM, under $D000)
+        lda     $01
+        sta     mmusave
+        and     #$F8
+        ora     #$06
+        sta     $01
+        tsx
+        stx     spsave
+
+; Save the zero page the C runtime uses, and set up the C stack
+        ldx     #zpspace-1
+@save:  lda     sp,x
+        sta     zpsave,x
+        dex
+        bpl     @save
+        lda     #<(__MAIN_START__ + __MAIN_SIZE__)
+        ldx     #>(__MAIN_START__ + __MAIN_SIZE__)
+        sta     sp
+        stx     sp+1
+
+; Constructors run from ONCE, which BSS reuses, so clear BSS after
+        jsr     initlib
+        jsr     zerobss
+        jsr     _con_init
+        jsr     _main
+
+; Back from main (and exit), with the return code in A
+_exit:  pha
+        jsr     _con_done
+        jsr     donelib
+        ldx     #zpspace-1
+@rest:  lda     zpsave,x
+        sta     sp,x
+        dex
+        bpl     @rest
+        pla
+        sta     STATUS
+        lda     mmusave
+        sta     $01
+        ldx     spsave
+        txs
+        rts
+
+.segment        "INIT"
+
+mmusave:.res    1
+spsave: .res    1
+zpsave: .res    zpspace
@@ -3,12 +3,26 @@
  */
 
 #include <cbm.h>
-#include <stdio.h>
 #include <stdlib.h>
 
+#include "console.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
+
 int main(void)
 {
+#ifdef BENCH
+    bench_start();
+#endif
+
     cbm_k_bsout(CH_FONT_UPPER);
-    printf("hello, world!\n");
+    con_puts("hello, world!\n");
+#ifdef BENCH
+    BENCH_COUNT();
+    bench_report("helloworld", "runs");
+#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,405 @@
+/**
+ * Host Shim
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * Just enough of the cc65 C64 library to run the programs natively, for
+ * profiling and debugging. Memory (including the VIC, SID and CIA
+ * registers) is a 64K array, and nothing happens behind the program's back:
+ * there are no interrupts, the raster never moves, and keys are scripted.
+ *
+ * environment:
+ *   HOST_KEYS        keys to press, in order, then 'q' (default: none)
+ *   HOST_POLLS       calls to kbhit before each key press (default: 1000)
+ *   HOST_DUMP        write frames to HOST_DUMP-NNNN.ppm (default: off)
+ *   HOST_DUMP_EVERY  calls to kbhit between frames, 0 for the last frame only
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <6502.h>
+#include <c64.h>
+#include <cc65.h>
+#include <conio.h>
+#include <tgi.h>
+
+#define TGI_X_SIZE 320
+#define TGI_Y_SIZE 200
+#define TGI_BITMAP 0xe000               // where the C64 hires drivers keep it
+
+// tgi bitmap byte holding pixel x, y (VIC hires layout)
+#define TGI_BYTE(x, y) \
+    mem64[TGI_BITMAP + ((y) >> 3) * 320 + ((x) & ~7) + ((y) & 7)]
+
+unsigned char mem64[65536];
+
+// C64 colors as RGB
+static const unsigned char RGB[16][3] = {
+    { 0x00, 0x00, 0x00 }, { 0xff, 0xff, 0xff }, { 0x68, 0x37, 0x2b }, { 0x70, 0xa4, 0xb2 },
+    { 0x6f, 0x3d, 0x86 }, { 0x58, 0x8d, 0x43 }, { 0x35, 0x28, 0x79 }, { 0xb8, 0xc7, 0x6f },
+    { 0x6f, 0x4f, 0x25 }, { 0x43, 0x39, 0x00 }, { 0x9a, 0x67, 0x59 }, { 0x44, 0x44, 0x44 },
+    { 0x6c, 0x6c, 0x6c }, { 0x9a, 0xd2, 0x84 }, { 0x6c, 0x5e, 0xb5 }, { 0x95, 0x95, 0x95 }
+};
+
+// scripted keys
+static const char *keys = "";
+static unsigned long key_polls = 1000;
+static unsigned long polls;
+
+// frame dump
+static const char *dump_name;
+static unsigned long dump_every;
+static unsigned long dump_polls;
+static unsigned frame;
+
+// tgi state (the bitmap is in mem64, so programs can write it directly)
+static unsigned char tgi_installed;
+static unsigned char tgi_color;
+static unsigned char tgi_palette[2] = { COLOR_BLACK, COLOR_WHITE };
+
+const char tgi_static_stddrv[] = "c64-hi.tgi";
+
+///// FRAME DUMP /////
+
+// render tgi bitmap, or VIC bitmap mode from memory (text mode is background only)
+static void render(unsigned char *out)
+{
+    unsigned bank, bitmap, screen, ofs;
+    unsigned char mode, b, c, x, y;
+    int px, py;
+
+    if (tgi_installed) {
+        for (py = 0; py < TGI_Y_SIZE; ++py)
+            for (px = 0; px < TGI_X_SIZE; ++px)
+                *out++ = tgi_palette[tgi_getpixel(px, py)];
+        return;
+    }
+
+    bank = (3 - (CIA2.pra & 3)) << 14;
+    bitmap = bank | ((VIC.addr & 0x08) << 10);
+    screen = bank | ((VIC.addr & 0xf0) << 6);
+    mode = (VIC.ctrl1 & 0x20) ? ((VIC.ctrl2 & 0x10) ? 2 : 1) : 0;
+    for (py = 0; py < 200; ++py) {
+        y = py >> 3;
+        for (px = 0; px < 320; ++px) {
+            x = px >> 3;
+            ofs = y * 40 + x;
+            b = mem64[bitmap + ofs * 8 + (py & 7)];
+            c = VIC.bgcolor0;
+            if (mode == 1) {
+                c = (b & (0x80 >> (px & 7))) ? mem64[screen + ofs] >> 4 : mem64[screen + ofs];
+            } else if (mode == 2) {
+                switch ((b >> (6 - (px & 6))) & 3) {
+                    case 1: c = mem64[screen + ofs] >> 4; break;
+                    case 2: c = mem64[screen + ofs]; break;
+                    case 3: c = COLOR_RAM[ofs]; break;
+                }
+            }
+            *out++ = c & 0xf;
+        }
+    }
+}
+
+static void dump_frame(void)
+{
+    static unsigned char pixels[TGI_Y_SIZE * TGI_X_SIZE];
+    char name[256];
+    FILE *f;
+    unsigned i;
+
+    snprintf(name, sizeof(name), "%s-%04u.ppm", dump_name, frame++);
+    if ((f = fopen(name, "wb")) == NULL) {
+        perror(name);
+        return;
+    }
+    render(pixels);
+    fprintf(f, "P6\n%d %d\n255\n", TGI_X_SIZE, TGI_Y_SIZE);
+    for (i = 0; i < sizeof(pixels); ++i)
+        fwrite(RGB[pixels[i]], 3, 1, f);
+    fclose(f);
+}
+
+static void host_exit(void)
+{
+    if (dump_name) dump_frame();
+}
+
+__attribute__((constructor))
+static void host_init(void)
+{
+    const char *s;
+
+    // power-on state: VIC bank 0, screen at 0x400, no keys down
+    CIA1.pra = 0x7f;
+    CIA1.prb = 0xff;
+    CIA2.pra = 0x97;
+    VIC.ctrl1 = 0x1b;
+    VIC.ctrl2 = 0xc8;
+    VIC.addr = 0x15;
+    VIC.bordercolor = COLOR_LIGHTBLUE;
+    VIC.bgcolor0 = COLOR_BLUE;
+    // unused VIC registers and mirrors read 0xff (not a C128 or SuperCPU)
+    memset(MEMPTR(0xd02f), 0xff, 0xd400 - 0xd02f);
+
+    if ((s = getenv("HOST_KEYS")) != NULL) keys = s;
+    if ((s = getenv("HOST_POLLS")) != NULL) key_polls = strtoul(s, NULL, 10);
+    if ((s = getenv("HOST_DUMP_EVERY")) != NULL) dump_every = strtoul(s, NULL, 10);
+    if ((dump_name = getenv("HOST_DUMP")) != NULL) atexit(host_exit);
+}
+
+///// 6502 /////
+
+void set_irq(irq_handler f, void *stack_addr, unsigned stack_size)
+{
+    (void)f;
+    (void)stack_addr;
+    (void)stack_size;
+}
+
+void reset_irq(void)
+{
+}
+
+///// CBM /////
+
+void cbm_k_bsout(unsigned char c)
+{
+    if (c != CH_FONT_LOWER && c != CH_FONT_UPPER) putchar(c);
+}
+
+unsigned char get_tv(void)
+{
+    return TV_PAL;
+}
+
+///// CC65 /////
+
+int _sin(unsigned x)
+{
+    return (int)lround(sin((x % 360) * M_PI / 180) * 256);
+}
+
+int _cos(unsigned x)
+{
+    return _sin(x + 90);
+}
+
+///// CONIO /////
+
+unsigned char kbhit(void)
+{
+    if (dump_name && dump_every && ++dump_polls >= dump_every) {
+        dump_polls = 0;
+        dump_frame();
+    }
+    return ++polls >= key_polls;
+}
+
+char cgetc(void)
+{
+    while (!kbhit()) ;
+    polls = 0;
+    return *keys ? *keys++ : 'q';
+}
+
+void clrscr(void)
+{
+    memset(MEMPTR(0x400), ' ', 1000);
+}
+
+void gotoxy(unsigned char x, unsigned char y)
+{
+    (void)x;
+    (void)y;
+}
+
+void cputc(char c)
+{
+    putchar(c);
+}
+
+void cputs(const char *s)
+{
+    fputs(s, stdout);
+}
+
+int cprintf(const char *format, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, format);
+    n = vprintf(format, ap);
+    va_end(ap);
+    return n;
+}
+
+unsigned char textcolor(unsigned char color)
+{
+    unsigned char old = PEEK(0x286);
+    POKE(0x286, color);
+    return old;
+}
+
+unsigned char bgcolor(unsigned char color)
+{
+    unsigned char old = VIC.bgcolor0 & 0xf;
+    VIC.bgcolor0 = color;
+    return old;
+}
+
+unsigned char bordercolor(unsigned char color)
+{
+    unsigned char old = VIC.bordercolor & 0xf;
+    VIC.bordercolor = color;
+    return old;
+}
+
+void screensize(unsigned char *x, unsigned char *y)
+{
+    *x = 40;
+    *y = 25;
+}
+
+// programs with their own waitvsync (qix-lines-multi-color) replace this one
+__attribute__((weak))
+void waitvsync(void)
+{
+}
+
+///// TGI /////
+
+void tgi_install(const void *driver)
+{
+    (void)driver;
+    tgi_installed = 1;
+}
+
+void tgi_load_driver(const char *name)
+{
+    tgi_install(name);
+}
+
+void tgi_uninstall(void)
+{
+    // keep the last picture for the frame dump at exit
+}
+
+void tgi_unload(void)
+{
+    tgi_uninstall();
+}
+
+unsigned char tgi_geterror(void)
+{
+    return TGI_ERR_OK;
+}
+
+void tgi_init(void)
+{
+    tgi_color = TGI_COLOR_WHITE;
+    tgi_palette[0] = COLOR_BLACK;
+    tgi_palette[1] = COLOR_WHITE;
+}
+
+void tgi_clear(void)
+{
+    memset(&mem64[TGI_BITMAP], 0, TGI_X_SIZE * TGI_Y_SIZE / 8);
+}
+
+unsigned tgi_getxres(void)
+{
+    return TGI_X_SIZE;
+}
+
+unsigned tgi_getyres(void)
+{
+    return TGI_Y_SIZE;
+}
+
+unsigned tgi_getmaxx(void)
+{
+    return TGI_X_SIZE - 1;
+}
+
+unsigned tgi_getmaxy(void)
+{
+    return TGI_Y_SIZE - 1;
+}
+
+unsigned char tgi_getcolorcount(void)
+{
+    return 2;
+}
+
+unsigned char tgi_getmaxcolor(void)
+{
+    return 1;
+}
+
+void tgi_setcolor(unsigned char color)
+{
+    tgi_color = color & 1;
+}
+
+unsigned char tgi_getcolor(void)
+{
+    return tgi_color;
+}
+
+void tgi_setpalette(const unsigned char *palette)
+{
+    tgi_palette[0] = palette[0] & 0xf;
+    tgi_palette[1] = palette[1] & 0xf;
+}
+
+const unsigned char *tgi_getpalette(void)
+{
+    return tgi_palette;
+}
+
+void tgi_setpixel(int x, int y)
+{
+    if (x >= 0 && y >= 0 && x < TGI_X_SIZE && y < TGI_Y_SIZE) {
+        if (tgi_color)
+            TGI_BYTE(x, y) |= 0x80 >> (x & 7);
+        else
+            TGI_BYTE(x, y) &= ~(0x80 >> (x & 7));
+    }
+}
+
+unsigned char tgi_getpixel(int x, int y)
+{
+    if (x >= 0 && y >= 0 && x < TGI_X_SIZE && y < TGI_Y_SIZE)
+        return (TGI_BYTE(x, y) >> (7 - (x & 7))) & 1;
+    return 0;
+}
+
+void tgi_line(int x1, int y1, int x2, int y2)
+{
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy, e2;
+
+    for (;;) {
+        tgi_setpixel(x1, y1);
+        if (x1 == x2 && y1 == y2) break;
+        e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x1 += sx; }
+        if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+void tgi_bar(int x1, int y1, int x2, int y2)
+{
+    int x, y;
+
+    for (y = y1; y <= y2; ++y)
+        for (x = x1; x <= x2; ++x)
+            tgi_setpixel(x, y);
+}
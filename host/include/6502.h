@@ -0,0 +1,24 @@
+/**
+ * Host Shim: 6502.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _6502_H
+#define _6502_H
+
+#define IRQ_NOT_HANDLED 0
+#define IRQ_HANDLED     1
+
+typedef unsigned char (*irq_handler)(void);
+
+// the handler is kept but never called, there are no interrupts on the host
+void set_irq(irq_handler f, void *stack_addr, unsigned stack_size);
+void reset_irq(void);
+
+#define SEI()
+#define CLI()
+#define BRK()
+
+#endif
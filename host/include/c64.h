@@ -0,0 +1,122 @@
+/**
+ * Host Shim: c64.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _C64_H
+#define _C64_H
+
+#include <cbm.h>
+#include <peekpoke.h>
+
+// VIC-II
+struct __vic2 {
+    struct {
+        unsigned char x;
+        unsigned char y;
+    } spr_pos[8];
+    unsigned char spr_hi_x;
+    unsigned char ctrl1;
+    unsigned char rasterline;
+    unsigned char strobe_x;
+    unsigned char strobe_y;
+    unsigned char spr_ena;
+    unsigned char ctrl2;
+    unsigned char spr_exp_y;
+    unsigned char addr;
+    unsigned char irr;
+    unsigned char imr;
+    unsigned char spr_bg_prio;
+    unsigned char spr_mcolor;
+    unsigned char spr_exp_x;
+    unsigned char spr_coll;
+    unsigned char spr_bg_coll;
+    unsigned char bordercolor;
+    unsigned char bgcolor0;
+    unsigned char bgcolor1;
+    unsigned char bgcolor2;
+    unsigned char bgcolor3;
+    unsigned char spr_mcolor0;
+    unsigned char spr_mcolor1;
+    unsigned char spr_color[8];
+    unsigned char x_kbd;
+    unsigned char clock;
+};
+
+// CIA
+struct __6526 {
+    unsigned char pra;
+    unsigned char prb;
+    unsigned char ddra;
+    unsigned char ddrb;
+    unsigned char ta_lo;
+    unsigned char ta_hi;
+    unsigned char tb_lo;
+    unsigned char tb_hi;
+    unsigned char tod_10;
+    unsigned char tod_sec;
+    unsigned char tod_min;
+    unsigned char tod_hour;
+    unsigned char sdr;
+    unsigned char icr;
+    unsigned char cra;
+    unsigned char crb;
+};
+
+// SID
+struct __sid_voice {
+    unsigned short freq;
+    unsigned short pw;
+    unsigned char ctrl;
+    unsigned char ad;
+    unsigned char sr;
+} __attribute__((packed));
+
+struct __sid {
+    struct __sid_voice v1;
+    struct __sid_voice v2;
+    struct __sid_voice v3;
+    unsigned short flt_freq;
+    unsigned char flt_ctrl;
+    unsigned char amp;
+    unsigned char ad1;
+    unsigned char ad2;
+    unsigned char noise;
+    unsigned char read3;
+} __attribute__((packed));
+
+// chips live in the memory array, so PEEK/POKE and the structs agree
+#define VIC       (*(struct __vic2 *)&mem64[0xd000])
+#define SID       (*(struct __sid *)&mem64[0xd400])
+#define CIA1      (*(struct __6526 *)&mem64[0xdc00])
+#define CIA2      (*(struct __6526 *)&mem64[0xdd00])
+#define COLOR_RAM ((unsigned char *)&mem64[0xd800])
+
+// colors
+#define COLOR_BLACK      0x00
+#define COLOR_WHITE      0x01
+#define COLOR_RED        0x02
+#define COLOR_CYAN       0x03
+#define COLOR_PURPLE     0x04
+#define COLOR_GREEN      0x05
+#define COLOR_BLUE       0x06
+#define COLOR_YELLOW     0x07
+#define COLOR_ORANGE     0x08
+#define COLOR_BROWN      0x09
+#define COLOR_LIGHTRED   0x0a
+#define COLOR_GRAY1      0x0b
+#define COLOR_GRAY2      0x0c
+#define COLOR_LIGHTGREEN 0x0d
+#define COLOR_LIGHTBLUE  0x0e
+#define COLOR_GRAY3      0x0f
+
+// video standard (always PAL)
+#define TV_NTSC  0
+#define TV_PAL   1
+#define TV_OTHER 2
+
+unsigned char get_tv(void);
+
+#endif
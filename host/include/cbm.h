@@ -0,0 +1,17 @@
+/**
+ * Host Shim: cbm.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _CBM_H
+#define _CBM_H
+
+#define CH_FONT_LOWER 14
+#define CH_FONT_UPPER 142
+
+// character output (to stdout, font switches ignored)
+void cbm_k_bsout(unsigned char c);
+
+#endif
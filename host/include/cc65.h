@@ -0,0 +1,15 @@
+/**
+ * Host Shim: cc65.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _CC65_H
+#define _CC65_H
+
+// sine and cosine of x degrees (0-359), times 256
+int _sin(unsigned x);
+int _cos(unsigned x);
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * Host Shim: conio.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _CONIO_H
+#define _CONIO_H
+
+// keys come from HOST_KEYS, one every HOST_POLLS calls to kbhit, then 'q'
+unsigned char kbhit(void);
+char cgetc(void);
+
+// screen (text goes to stdout, colors go to the VIC registers)
+void clrscr(void);
+void gotoxy(unsigned char x, unsigned char y);
+void cputc(char c);
+void cputs(const char *s);
+int cprintf(const char *format, ...);
+unsigned char textcolor(unsigned char color);
+unsigned char bgcolor(unsigned char color);
+unsigned char bordercolor(unsigned char color);
+void screensize(unsigned char *x, unsigned char *y);
+
+// count a frame (there is no raster to wait for)
+void waitvsync(void);
+
+#endif
@@ -0,0 +1,17 @@
+/**
+ * Host Shim: joystick.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _JOYSTICK_H
+#define _JOYSTICK_H
+
+#define JOY_UP_MASK    0x01
+#define JOY_DOWN_MASK  0x02
+#define JOY_LEFT_MASK  0x04
+#define JOY_RIGHT_MASK 0x08
+#define JOY_BTN_1_MASK 0x10
+
+#endif
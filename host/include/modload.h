@@ -0,0 +1,13 @@
+/**
+ * Host Shim: modload.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _MODLOAD_H
+#define _MODLOAD_H
+
+// included by the programs, but modules are not loaded on the host
+
+#endif
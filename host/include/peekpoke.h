@@ -0,0 +1,22 @@
+/**
+ * Host Shim: peekpoke.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _PEEKPOKE_H
+#define _PEEKPOKE_H
+
+// C64 memory
+extern unsigned char mem64[65536];
+
+#define POKE(addr, val)  (mem64[(unsigned short)(addr)] = (unsigned char)(val))
+#define POKEW(addr, val) (POKE(addr, val), POKE((addr) + 1, (unsigned)(val) >> 8))
+#define PEEK(addr)       (mem64[(unsigned short)(addr)])
+#define PEEKW(addr)      (PEEK(addr) | (PEEK((addr) + 1) << 8))
+
+// pointer to C64 memory at addr (see MEMPTR in common.h)
+#define MEMPTR(addr) ((void *)&mem64[(unsigned short)(addr)])
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * Host Shim: tgi.h
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _TGI_H
+#define _TGI_H
+
+// 320x200, 2 color hires driver
+#define TGI_COLOR_BLACK 0
+#define TGI_COLOR_WHITE 1
+
+#define TGI_ERR_OK 0
+
+extern const char tgi_static_stddrv[];
+
+void tgi_install(const void *driver);
+void tgi_load_driver(const char *name);
+void tgi_uninstall(void);
+void tgi_unload(void);
+unsigned char tgi_geterror(void);
+void tgi_init(void);
+void tgi_clear(void);
+
+unsigned tgi_getxres(void);
+unsigned tgi_getyres(void);
+unsigned tgi_getmaxx(void);
+unsigned tgi_getmaxy(void);
+unsigned char tgi_getcolorcount(void);
+unsigned char tgi_getmaxcolor(void);
+
+void tgi_setcolor(unsigned char color);
+unsigned char tgi_getcolor(void);
+void tgi_setpalette(const unsigned char *palette);
+const unsigned char *tgi_getpalette(void);
+
+void tgi_setpixel(int x, int y);
+unsigned char tgi_getpixel(int x, int y);
+void tgi_line(int x1, int y1, int x2, int y2);
+void tgi_bar(int x1, int y1, int x2, int y2);
+
+#endif
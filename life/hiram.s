@@ -0,0 +1,34 @@
+;
+; Clear the GRID and TABLES segments at startup (see c64.cfg)
+;
+; The cc65 startup code only clears BSS, so clear the RAM areas holding
+; these segments too, as C expects of static data.
+;
+
+        .constructor    clear_hiram
+        .import         __BASICRAM_START__, __BASICRAM_SIZE__
+        .import         __HIRAM_START__, __HIRAM_SIZE__
+        .importzp       ptr1
+
+.segment        "ONCE"
+
+clear_hiram:
+        lda     #>__BASICRAM_START__
+        ldx     #>__BASICRAM_SIZE__
+        jsr     clear_pages
+        lda     #>__HIRAM_START__
+        ldx     #>__HIRAM_SIZE__
+
+; clear X pages from page A
+clear_pages:
+        sta     ptr1+1
+        lda     #$00
+        sta     ptr1
+        tay
+@loop:  sta     (ptr1),y
+        iny
+        bne     @loop
+        inc     ptr1+1
+        dex
+        bne     @loop
+        rts
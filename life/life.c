@@ -14,6 +14,20 @@
 #include <stdlib.h>
 #include <tgi.h>
 
+#include "machine.h"
+#include "profile.h"
+#include "rng.h"
+#include "speedcode.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
+
+// tgi driver file, for TGI_MODULE builds
+#ifndef TGI_DRIVER
+#define TGI_DRIVER "c64-hi.tgi"
+#endif
+
 #define TRUE      1
 #define FALSE     0
 #define COLOR_BG  TGI_COLOR_BLACK
@@ -22,6 +36,13 @@
 #define Y_SIZE    200
 #define CELL_SIZE 1000
 #define GRID_SIZE (X_SIZE * Y_SIZE)
+#define BITMAP    0xe000                // where the hires tgi drivers keep the bitmap
+
+// profile zones (see profile.h)
+#define PZ_MARK  0                      // mark cells and neighbors to check
+#define PZ_CHECK 1                      // check them for life
+#define PZ_CLEAR 2                      // clear_cells
+#define PZ_DRAW  3                      // draw_next_cells
 
 // predefined cell types
 #define CT_RANDOM    0
@@ -30,15 +51,92 @@
 #define CT_GLIDER_SE 3
 #define CT_GLIDER_SW 4
 
+// oscillation detection
+#define PERIOD_MAX  16                  // longest period looked for (a power of 2)
+#define CACHE_SIZE  2048                // cells kept for the generations of a period
+#define SKIP_GENERATIONS 1000           // generations the f key skips
+
+// period states
+#define PS_LOOK   0                     // compare each hash with the last PERIOD_MAX
+#define PS_RECORD 1                     // hash matched p back, check and cache p more
+#define PS_CYCLE  2                     // periodic, show the cached generations
+
+// generation step states (see life_step)
+#define STEP_IDLE  0                    // no generation under way
+#define STEP_MARK  1                    // mark neighbors to check, keep survivors
+#define STEP_CHECK 2                    // check the marked neighbors for births
+#define STEP_DRAW  3                    // draw the next cells (old ones cleared)
+
+// cells marked, checked or drawn between key checks
+#ifndef STEP_CELLS
+#define STEP_CELLS 16
+#endif
+
 typedef unsigned char bool;
 typedef unsigned char byte;
 typedef unsigned short ushort;
+typedef unsigned long ulong;
+
+// generation hash (the same for the same cells in any order)
+typedef struct {
+    ushort count;
+    ushort sum;
+    ushort xor;
+} gen_hash_s;
 
 // globals
+ushort cell_p, next_p;
+ulong generation;
+gen_hash_s hash;                        // of the cells drawn last
+byte period;                            // once periodic, 0 before
+
+// large buffers, in the RAM above the program (see c64.cfg)
+#pragma bss-name (push, "GRID")
 byte work[GRID_SIZE / 8];
+#pragma bss-name (pop)
+
+#pragma bss-name (push, "TABLES")
 ushort cell[CELL_SIZE];
 ushort next[CELL_SIZE];
-ushort cell_p, next_p;
+#pragma bss-name (pop)
+
+// bitmap address of column 0 on each row
+ushort row_addr[Y_SIZE];
+
+// code to clear the bitmap bytes holding the cells in cell, a sta per cell
+// (whole bytes can go, as every pixel set is a cell and the next cells are
+// drawn again after)
+speedcode_s erase;
+byte erase_code[SPEEDCODE_STORE_SIZE(CELL_SIZE)];
+
+void erase_init()
+{
+    byte y;
+
+    for (y = 0; y < Y_SIZE; y++)
+        row_addr[y] = BITMAP + (y >> 3) * X_SIZE + (y & 7);
+    speedcode_init(&erase, erase_code, sizeof(erase_code));
+    speedcode_load(&erase, 0);
+}
+
+void erase_reset()
+{
+    speedcode_reset(&erase);
+    speedcode_load(&erase, 0);
+}
+
+void erase_add(short x, short y)
+{
+    speedcode_store(&erase, row_addr[y] + (x & ~7));
+}
+
+// hashes of the last PERIOD_MAX generations, and the cells of each
+// generation in a period, once one is found
+gen_hash_s hash_history[PERIOD_MAX];
+byte hash_head, hash_fill;
+byte period_state, phase;
+ushort period_cache[CACHE_SIZE];
+ushort frame_start[PERIOD_MAX + 1];
 
 void set_work_bit(const short x, const short y, const bool val)
 {
@@ -96,20 +194,38 @@ void clear_cells()
 {
     ushort i;
 
-    tgi_setcolor(COLOR_BG);
-    for (i = 0; i < cell_p; i++)
-        tgi_setpixel(cell[i] % X_SIZE, cell[i] / X_SIZE);
+    if (erase.full) {
+        tgi_setcolor(COLOR_BG);
+        for (i = 0; i < cell_p; i++)
+            tgi_setpixel(cell[i] % X_SIZE, cell[i] / X_SIZE);
+    } else {
+        speedcode_run(&erase);
+    }
+    erase_reset();
 }
 
-void draw_next_cells()
+// draw next cells i up to end, adding them to the hash
+void draw_next_range(ushort i, ushort end)
 {
-    ushort i;
+    short x, y;
 
     tgi_setcolor(COLOR_FG);
-    for (i = 0; i < next_p; i++) {
-        tgi_setpixel(next[i] % X_SIZE, next[i] / X_SIZE);
-        cell[i] = next[i];
+    for (; i < end; i++) {
+        x = next[i] % X_SIZE;
+        y = next[i] / X_SIZE;
+        tgi_setpixel(x, y);
+        erase_add(x, y);
+        hash.sum += next[i];
+        hash.xor ^= next[i];
     }
+}
+
+void draw_next_cells()
+{
+    hash.count = next_p;
+    hash.sum = hash.xor = 0;
+    draw_next_range(0, next_p);
+    fast_copy(cell, next, next_p * sizeof(ushort));
     cell_p = next_p;
 }
 
@@ -120,6 +236,7 @@ void add_cell(short x, short y)
     if (cell_p < CELL_SIZE - 1) {
         cell[cell_p++] = pos;
         tgi_setpixel(x, y);
+        erase_add(x, y);
     }
 }
 
@@ -140,7 +257,7 @@ void add_random(short x, short y)
     y = (y < 10) ? 10 : (y >= Y_SIZE - 10) ? (Y_SIZE - 11) : y;
     for (yy = y - 10; yy < y + 10; yy++) {
         for (xx = x - 10; xx < x + 10; xx++) {
-            if ((rand() % 2) == 0) {
+            if (RNG_BYTE() & 1) {
                 add_cell(xx, yy);
             }
         }
@@ -209,31 +326,231 @@ void add_shape(const byte type, const short x, const short y)
     }
 }
 
+// generation step state, and the cell it is up to
+byte step_state;
+ushort step_i;
+
+// end of a slice of at most n cells from step_i, out of count
+ushort step_end(ushort count, ushort n)
+{
+    return (count - step_i > n) ? step_i + n : count;
+}
+
+// work the next generation out and draw it, at most n cells at a time, so
+// keys can be checked between slices: call until it returns TRUE, when the
+// generation is drawn and counted
+// (the screen holds the cells being worked out until the last slice, as the
+// checks read it)
+byte life_step(ushort n)
+{
+    ushort end, pos;
+    short x, y, xx, yy;
+
+    switch (step_state) {
+        case STEP_IDLE:
+            next_p = 0;
+            step_i = 0;
+            step_state = STEP_MARK;
+            // fall through
+
+        case STEP_MARK:
+            // process cells
+            PROFILE_ENTER(PZ_MARK, "mark");
+            for (end = step_end(cell_p, n); step_i < end; step_i++) {
+                pos = cell[step_i];
+                x = pos % X_SIZE;
+                y = pos / X_SIZE;
+
+                // add all neighbors to work
+                for (xx = x - 1; xx <= x + 1; xx++)
+                    for (yy = y - 1; yy <= y + 1; yy++) {
+                        set_work_bit(xx, yy, TRUE);
+                    }
+
+                // if cell is still alive, add to next
+                if (check_cell(x, y, TRUE))
+                    add_next(x, y);
+            }
+            PROFILE_EXIT(PZ_MARK);
+            if (step_i == cell_p) {
+                step_i = 0;
+                step_state = STEP_CHECK;
+            }
+            return FALSE;
+
+        case STEP_CHECK:
+            // process cell neighbors
+            PROFILE_ENTER(PZ_CHECK, "check");
+            for (end = step_end(cell_p, n); step_i < end; step_i++) {
+                pos = cell[step_i];
+                x = pos % X_SIZE;
+                y = pos / X_SIZE;
+                // check neighbor cells for life and add to next as appropriate
+                for (xx = x - 1; xx <= x + 1; xx++)
+                    for (yy = y - 1; yy <= y + 1; yy++) {
+                        if (get_work_bit(xx, yy) && check_neighbor(xx, yy))
+                            add_next(xx, yy);
+                        set_work_bit(xx, yy, FALSE);
+                    }
+            }
+            PROFILE_EXIT(PZ_CHECK);
+            if (step_i < cell_p) return FALSE;
+
+            // remove dead cells from screen
+            PROFILE_ENTER(PZ_CLEAR, "clear");
+            clear_cells();
+            PROFILE_EXIT(PZ_CLEAR);
+            hash.count = next_p;
+            hash.sum = hash.xor = 0;
+            step_i = 0;
+            step_state = STEP_DRAW;
+            return FALSE;
+
+        case STEP_DRAW:
+            // draw life cells to screen
+            PROFILE_ENTER(PZ_DRAW, "draw");
+            end = step_end(next_p, n);
+            draw_next_range(step_i, end);
+            step_i = end;
+            PROFILE_EXIT(PZ_DRAW);
+            if (step_i < next_p) return FALSE;
+
+            // copy next array to cell array
+            fast_copy(cell, next, next_p * sizeof(ushort));
+            cell_p = next_p;
+            step_state = STEP_IDLE;
+            generation++;
+            return TRUE;
+    }
+    return FALSE;
+}
+
+// stop the generation under way before cells are added or cleared: one being
+// drawn is finished, and one being worked out is dropped (unmarking the work
+// bits set so far)
+void step_abort()
+{
+    if (step_state == STEP_DRAW) {
+        while (!life_step(CELL_SIZE)) ;
+    } else if (step_state != STEP_IDLE) {
+        fast_clear(work, sizeof(work));
+        step_state = STEP_IDLE;
+    }
+}
+
+// forget the hashes (after cells are added or cleared)
+void period_reset()
+{
+    hash_fill = 0;
+    period_state = PS_LOOK;
+    period = 0;
+}
+
+// look for a repeat of the generation just drawn in the last PERIOD_MAX, and
+// once one is found, check and cache the next period's worth of generations
+void period_check()
+{
+    gen_hash_s *h;
+    ushort start;
+    byte p;
+
+    switch (period_state) {
+        case PS_LOOK:
+            for (p = 1; p <= hash_fill; p++) {
+                h = &hash_history[(hash_head - p) & (PERIOD_MAX - 1)];
+                if (h->count == hash.count && h->sum == hash.sum &&
+                    h->xor == hash.xor) {
+                    period = p;
+                    period_state = PS_RECORD;
+                    phase = 0;
+                    frame_start[0] = 0;
+                    break;
+                }
+            }
+            break;
+        case PS_RECORD:
+            h = &hash_history[(hash_head - period) & (PERIOD_MAX - 1)];
+            start = frame_start[phase];
+            if (h->count != hash.count || h->sum != hash.sum ||
+                h->xor != hash.xor || cell_p > CACHE_SIZE - start) {
+                // a collision, or too many cells to cache
+                period = 0;
+                period_state = PS_LOOK;
+                break;
+            }
+            fast_copy(&period_cache[start], cell, cell_p * sizeof(ushort));
+            frame_start[++phase] = start + cell_p;
+            if (phase == period) {
+                phase = 0;
+                period_state = PS_CYCLE;
+            }
+            break;
+    }
+
+    hash_history[hash_head] = hash;
+    hash_head = (hash_head + 1) & (PERIOD_MAX - 1);
+    if (hash_fill < PERIOD_MAX) hash_fill++;
+}
+
+// show the generation skip generations on from the one drawn, from the cache
+// (once a frame, there is nothing to work out)
+void period_step(ulong skip)
+{
+    generation += skip;
+    if (skip > 1) phase = (phase + (skip - 1) % period) % period;
+    waitvsync();
+    if (period > 1) {
+        clear_cells();
+        next_p = frame_start[phase + 1] - frame_start[phase];
+        fast_copy(next, &period_cache[frame_start[phase]],
+                  next_p * sizeof(ushort));
+        draw_next_cells();
+    }
+    if (++phase == period) phase = 0;
+}
+
 // draw cells in a loop, controlled by key presses
 void draw_loop()
 {
     byte key, key1, key2, mode;
-    ushort i, pos;
-    short x, y, xx, yy, cx, cy;
+    short cx, cy;
+    ulong skip;
 
     cell_p = 0;
+    generation = 0;
+    skip = 0;
+    step_state = STEP_IDLE;
+    erase_init();
+    period_reset();
     cx = X_SIZE / 2;
     cy = Y_SIZE / 2;
 
     // randomize initial state
+#ifdef BENCH
+    add_shape(CT_RANDOM, cx, cy);
+#else
     //add_shape(CT_RANDOM, cx, cy);
     add_shape(CT_GLIDER_SE, cx, cy);
+#endif
 
     // mode 0: exit
     // mode 1: pause until key-press
     // mode 2: run continuously
     mode = 1;
-    key1 = key2 = 0;
+#ifdef BENCH
+    // run until time is up
+    mode = 2;
+    bench_start();
+#endif
+    PROFILE_START();
+    key = key1 = key2 = 0;
     while (mode > 0) {
         tgi_setcolor(COLOR_FG);
 
         if (kbhit())
             key = cgetc();
+        if (PROFILE_KEY(key))
+            key = 0;
 
         switch (key) {
             case 'q':
@@ -244,8 +561,13 @@ void draw_loop()
                 else mode = 1;
                 break;
             case 'c':
+                step_abort();
                 clear_cells();
                 cell_p = 0;
+                period_reset();
+                break;
+            case 'f':
+                skip += SKIP_GENERATIONS;
                 break;
         }
 
@@ -258,51 +580,32 @@ void draw_loop()
             if (key2 == 'q')
                 mode = 0;
             else if (key2 > 0) {
+                step_abort();
                 add_shape((key1 - '0') * 10 + key2 - '0', cx, cy);
+                period_reset();
                 key1 = key2 = 0;
             }
         }
 
-        if (mode == 2 || key == ' ') {
-            next_p = 0;
-
-            // process cells
-            for (i = 0; i < cell_p; i++) {
-                pos = cell[i];
-                x = pos % X_SIZE;
-                y = pos / X_SIZE;
-
-                // add all neighbors to work
-                for (xx = x - 1; xx <= x + 1; xx++)
-                    for (yy = y - 1; yy <= y + 1; yy++) {
-                        set_work_bit(xx, yy, TRUE);
-                    }
-
-                // if cell is still alive, add to next
-                if (check_cell(x, y, TRUE))
-                    add_next(x, y);
-            }
-
-            // process cell neighbors
-            for (i = 0; i < cell_p; i++) {
-                pos = cell[i];
-                x = pos % X_SIZE;
-                y = pos / X_SIZE;
-                // check neighbor cells for life and add to next as appropriate
-                for (xx = x - 1; xx <= x + 1; xx++)
-                    for (yy = y - 1; yy <= y + 1; yy++) {
-                        if (get_work_bit(xx, yy) && check_neighbor(xx, yy))
-                            add_next(xx, yy);
-                        set_work_bit(xx, yy, FALSE);
-                    }
+        // once periodic, skip ahead in one go
+        if (period_state == PS_CYCLE && (mode == 2 || key == ' ' || skip)) {
+            period_step(skip ? skip : 1);
+            skip = 0;
+        } else if (mode == 2 || key == ' ' || skip || step_state != STEP_IDLE) {
+            // a slice of the generation, finishing it even if paused
+            if (life_step(STEP_CELLS)) {
+                PROFILE_STEP();
+                if (skip) skip--;
+#ifndef BENCH
+                // (the benchmark keeps working every generation out)
+                period_check();
+#endif
+
+#ifdef BENCH
+                BENCH_COUNT();
+                if (bench_done()) mode = 0;
+#endif
             }
-
-            // remove dead cells from screen
-            clear_cells();
-
-            // draw life cells to screen
-            // and copy next array to cell array
-            draw_next_cells();
         }
 
         key = 0;
@@ -313,10 +616,27 @@ int main(void)
 {
     byte border_color;
 
+    // run at SuperCPU speed, if there is one
+    machine_detect();
+    machine_turbo(TRUE);
+
     // setup tgi
+#ifdef TGI_MODULE
+    // load driver from disk, instead of linking it in
+    tgi_load_driver(TGI_DRIVER);
+    if (tgi_geterror() != TGI_ERR_OK) {
+        cputs("cannot load " TGI_DRIVER "\r\n");
+        return EXIT_FAILURE;
+    }
+#else
     tgi_install(tgi_static_stddrv);
+#endif
     tgi_init();
-    tgi_clear();
+    // the REU clears a byte a cycle, several times faster than the driver
+    if (machine.reu_banks)
+        fast_clear(MEMPTR(BITMAP), X_SIZE * Y_SIZE / 8);
+    else
+        tgi_clear();
 
     // persist border color
     border_color = bordercolor(COLOR_BG);
@@ -328,8 +648,21 @@ int main(void)
     bordercolor(border_color);
 
     // cleanup tgi
+#ifdef TGI_MODULE
+    tgi_unload();
+#else
     tgi_uninstall();
+#endif
     clrscr();
 
+    // how far it got, and whether it settled
+    printf("generation %lu", generation);
+    if (period) printf(", period %u", period);
+    printf("\n");
+
+#ifdef BENCH
+    bench_report("life", "generations");
+#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,107 @@
+/**
+ * Machine Capabilities
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#include <c64.h>
+#include <peekpoke.h>
+#include <string.h>
+
+#include "machine.h"
+
+// REU registers
+#define REU_COMMAND 0xdf01
+#define REU_C64     0xdf02
+#define REU_REU     0xdf04
+#define REU_BANK    0xdf06
+#define REU_LENGTH  0xdf07
+#define REU_CONTROL 0xdf0a
+
+// REU commands (run at once, without waiting for a write to 0xff00)
+#define REU_STASH   0x90                // C64 to REU
+#define REU_FETCH   0x91                // REU to C64
+
+// REU control
+#define REU_FIX_REU 0x40                // keep REU address fixed
+
+// SuperCPU registers
+#define SCPU_STATUS 0xd0bc              // bit 7 clear on a SuperCPU
+#define SCPU_SLOW   0xd07a              // write for 1 MHz
+#define SCPU_TURBO  0xd07b              // write for 20 MHz
+
+machine_s machine;
+
+// REU scratch space for fast_fill and fast_copy
+#define REU_SCRATCH 0UL
+
+static void reu_dma(unsigned char command, const void *p, unsigned long reu, unsigned short len)
+{
+    POKEW(REU_C64, (unsigned short)p);
+    POKEW(REU_REU, (unsigned short)reu);
+    POKE(REU_BANK, reu >> 16);
+    POKEW(REU_LENGTH, len);
+    POKE(REU_COMMAND, command);
+}
+
+// number of 64K banks, by writing each bank number to its bank (highest
+// first, so a smaller REU that wraps around keeps its own numbers) and
+// reading them back
+static unsigned short reu_size(void)
+{
+    unsigned char b, v;
+    unsigned short banks;
+
+    POKE(REU_CONTROL, 0);
+    b = 255;
+    do {
+        v = b;
+        reu_dma(REU_STASH, &v, (unsigned long)b << 16, 1);
+    } while (b-- != 0);
+    for (banks = 0; banks < 256; ++banks) {
+        v = ~banks;
+        reu_dma(REU_FETCH, &v, (unsigned long)banks << 16, 1);
+        if (v != (unsigned char)banks) break;
+    }
+    return banks;
+}
+
+void machine_detect(void)
+{
+    machine.tv = get_tv();
+    machine.lines = (machine.tv == TV_NTSC) ? 263 : 312;
+    machine.reu_banks = reu_size();
+    machine.scpu = !(PEEK(SCPU_STATUS) & 0x80);
+    // 0xd030 is an unused register reading 0xff on a C64's VIC
+    machine.c128 = !machine.scpu && VIC.clock != 0xff;
+}
+
+void machine_turbo(unsigned char on)
+{
+    if (machine.scpu) POKE(on ? SCPU_TURBO : SCPU_SLOW, 0);
+}
+
+void fast_fill(void *p, unsigned char value, unsigned short len)
+{
+    if (machine.reu_banks && len >= REU_MIN_LENGTH) {
+        // one byte in the REU, fetched over and over from the same address
+        reu_dma(REU_STASH, &value, REU_SCRATCH, 1);
+        POKE(REU_CONTROL, REU_FIX_REU);
+        reu_dma(REU_FETCH, p, REU_SCRATCH, len);
+        POKE(REU_CONTROL, 0);
+    } else {
+        memset(p, value, len);
+    }
+}
+
+void fast_copy(void *dst, const void *src, unsigned short len)
+{
+    if (machine.reu_banks && len >= REU_MIN_LENGTH) {
+        // all of src is in the REU before any of dst is written
+        reu_dma(REU_STASH, src, REU_SCRATCH, len);
+        reu_dma(REU_FETCH, dst, REU_SCRATCH, len);
+    } else {
+        memmove(dst, src, len);
+    }
+}
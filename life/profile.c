@@ -0,0 +1,158 @@
+/**
+ * Profile
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifdef PROFILE
+
+#include <c64.h>
+#include <cbm.h>
+#include <peekpoke.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+
+#define PROFILE_LFN    4                // printer logical file number
+#define PROFILE_DEVICE 4                // printer device
+
+// zones
+static const char *zone_name[PROFILE_ZONES];
+static unsigned long zone_start[PROFILE_ZONES];
+static unsigned long zone_cycles[PROFILE_ZONES];
+static unsigned long zone_count[PROFILE_ZONES];
+static unsigned char zone_border[PROFILE_ZONES];
+
+// counter at profile_start (or the last dump), and steps since
+static unsigned long total_start;
+static unsigned long step_count;
+
+// border colors on, and the border color from before
+static unsigned char border_on;
+static unsigned char border_color;
+
+// cycles counted since profile_start
+// (timer A is stopped while it is read, which stops timer B too, so the two
+// halves agree, and the time spent here is left out)
+static unsigned long profile_now(void)
+{
+    unsigned lo, hi;
+
+    CIA2.cra = 0;
+    lo = CIA2.ta_lo | (CIA2.ta_hi << 8);
+    hi = CIA2.tb_lo | (CIA2.tb_hi << 8);
+    CIA2.cra = 0x01;
+    // the timers count down
+    return ~(((unsigned long)hi << 16) | lo);
+}
+
+static void profile_empty(void)
+{
+    memset(zone_cycles, 0, sizeof(zone_cycles));
+    memset(zone_count, 0, sizeof(zone_count));
+    step_count = 0;
+    total_start = profile_now();
+}
+
+void profile_start(void)
+{
+    CIA2.cra = 0;
+    CIA2.crb = 0;
+    CIA2.ta_lo = 0xff;
+    CIA2.ta_hi = 0xff;
+    CIA2.tb_lo = 0xff;
+    CIA2.tb_hi = 0xff;
+    // timer B counts timer A underflows, timer A counts cycles
+    CIA2.crb = 0x51;
+    CIA2.cra = 0x11;
+    profile_empty();
+}
+
+void profile_enter(unsigned char n, const char *name)
+{
+    zone_name[n] = name;
+    if (border_on) {
+        zone_border[n] = VIC.bordercolor;
+        VIC.bordercolor = n + 2;
+    }
+    zone_start[n] = profile_now();
+}
+
+void profile_exit(unsigned char n)
+{
+    zone_cycles[n] += profile_now() - zone_start[n];
+    ++zone_count[n];
+    if (border_on)
+        VIC.bordercolor = zone_border[n];
+}
+
+void profile_step(void)
+{
+    ++step_count;
+}
+
+static void profile_puts(const char *s)
+{
+    cbm_write(PROFILE_LFN, s, strlen(s));
+}
+
+static void profile_putn(unsigned long n)
+{
+    char buf[12];
+
+    profile_puts(" ");
+    profile_puts(ultoa(n, buf, 10));
+}
+
+void profile_dump(void)
+{
+    unsigned long total = profile_now() - total_start;
+    unsigned char port = PEEK(1);
+    unsigned char n;
+
+    // the printer needs the KERNAL, which some programs bank out
+    // (BASIC stays out)
+    POKE(1, (port & ~0b111) | 0b110);
+    if (cbm_open(PROFILE_LFN, PROFILE_DEVICE, 0, "") == 0) {
+        for (n = 0; n < PROFILE_ZONES; n++) {
+            if (!zone_count[n]) continue;
+            profile_puts(zone_name[n]);
+            profile_putn(zone_count[n]);
+            profile_putn(zone_cycles[n]);
+            profile_putn(zone_cycles[n] / zone_count[n]);
+            profile_putn(step_count ? zone_cycles[n] / step_count : 0);
+            profile_putn(total >= 100 ? zone_cycles[n] / (total / 100) : 0);
+            profile_puts("%\r");
+        }
+        profile_puts("steps");
+        profile_putn(step_count);
+        profile_puts("\r");
+        profile_puts("total");
+        profile_putn(total);
+        profile_puts("\r\r");
+        cbm_close(PROFILE_LFN);
+    }
+    POKE(1, port);
+    profile_empty();
+}
+
+unsigned char profile_key(char key)
+{
+    switch (key) {
+        case PROFILE_KEY_DUMP:
+            profile_dump();
+            return 1;
+        case PROFILE_KEY_BORDER:
+            border_on = !border_on;
+            if (border_on)
+                border_color = VIC.bordercolor;
+            else
+                VIC.bordercolor = border_color;
+            return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * Profile
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * Cycles spent in named zones of a program, counted with the CIA2 timers.
+ * Wrap each part of a frame or generation in PROFILE_ENTER/PROFILE_EXIT,
+ * mark the end of each frame or generation with PROFILE_STEP (zones may be
+ * entered more or less often than that), build with -DPROFILE (make profile), and press PROFILE_KEY_DUMP to print
+ * a summary, or PROFILE_KEY_BORDER to color the border while in each zone.
+ * Without PROFILE the macros are empty and nothing is linked in.
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+// max zones
+#ifndef PROFILE_ZONES
+#define PROFILE_ZONES 8
+#endif
+
+// keys that print the summary (to the printer) and toggle border colors
+#ifndef PROFILE_KEY_DUMP
+#define PROFILE_KEY_DUMP 'p'
+#endif
+#ifndef PROFILE_KEY_BORDER
+#define PROFILE_KEY_BORDER 'b'
+#endif
+
+#ifdef PROFILE
+
+// start counting, with all zones empty
+#define PROFILE_START() profile_start()
+
+// enter and exit zone n (0 to PROFILE_ZONES - 1), which is called name in
+// the summary (zones may nest, each counts all the time spent inside it)
+#define PROFILE_ENTER(n, name) profile_enter(n, name)
+#define PROFILE_EXIT(n) profile_exit(n)
+
+// count a step (a frame or generation)
+#define PROFILE_STEP() profile_step()
+
+// handle key if it is a profile key, and return true if it was
+#define PROFILE_KEY(key) profile_key(key)
+
+///// FUNCTIONS /////
+
+// start CIA2 timers A and B as a free running 32-bit cycle counter, and
+// empty all zones
+void profile_start(void);
+
+void profile_enter(unsigned char n, const char *name);
+
+void profile_exit(unsigned char n);
+
+void profile_step(void);
+
+// print "name count cycles cycles/count cycles/step percent" for each zone
+// used, and the steps and total cycles, to the printer (device 4), then
+// empty all zones
+// (banks the KERNAL in for the printer, if it was out)
+void profile_dump(void);
+
+unsigned char profile_key(char key);
+
+#else
+
+#define PROFILE_START()
+#define PROFILE_ENTER(n, name)
+#define PROFILE_EXIT(n)
+#define PROFILE_STEP()
+#define PROFILE_KEY(key) 0
+
+#endif
+
+#endif
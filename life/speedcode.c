@@ -0,0 +1,236 @@
+/**
+ * Speedcode
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#include <peekpoke.h>
+#include <stddef.h>
+
+#include "speedcode.h"
+
+// opcodes
+#define AND_IMM  0x29
+#define BNE      0xd0
+#define INX      0xe8
+#define LDA_ABS  0xad
+#define LDA_IMM  0xa9
+#define LDA_ZP   0xa5
+#define LDX_IMM  0xa2
+#define PHA      0x48
+#define PHP      0x08
+#define PLA      0x68
+#define PLP      0x28
+#define RTS      0x60
+#define SEI      0x78
+#define STA_ABS  0x8d
+#define STA_ABSX 0x9d
+#define STA_ZP   0x85
+
+#define FILL_PAGES 32                   // pages per fill loop, so bne reaches back
+
+// bytes to open and close a group (php, sei, ROM out ... ROM back, plp)
+#define OPEN_SIZE  9
+#define CLOSE_SIZE 4
+
+// write the closing code at pc: end the open group, then rts
+static void finish(speedcode_s *sc)
+{
+    unsigned char *p = sc->pc;
+
+    if (sc->run) {
+        p[0] = PLA;
+        p[1] = STA_ZP;
+        p[2] = 0x01;
+        p[3] = PLP;
+        p += CLOSE_SIZE;
+    }
+    *p = RTS;
+}
+
+// room for n more bytes of instructions, and the closing code after them?
+static unsigned char room(speedcode_s *sc, unsigned short n)
+{
+    if (sc->pc + n + CLOSE_SIZE + 1 <= sc->end) return 1;
+    sc->full = 1;
+    return 0;
+}
+
+void speedcode_init(speedcode_s *sc, void *buf, unsigned short size)
+{
+    sc->start = buf;
+    sc->end = sc->start + size;
+    speedcode_reset(sc);
+}
+
+void speedcode_reset(speedcode_s *sc)
+{
+    sc->pc = sc->start;
+    sc->last = NULL;
+    sc->run = 0;
+    sc->full = 0;
+    finish(sc);
+}
+
+unsigned short speedcode_size(speedcode_s *sc)
+{
+    return sc->pc - sc->start + (sc->run ? CLOSE_SIZE : 0) + 1;
+}
+
+unsigned char speedcode_load(speedcode_s *sc, unsigned char value)
+{
+    if (!room(sc, 2)) return 0;
+    sc->pc[0] = LDA_IMM;
+    sc->pc[1] = value;
+    sc->pc += 2;
+    sc->last = NULL;
+    finish(sc);
+    return 1;
+}
+
+unsigned char speedcode_store(speedcode_s *sc, unsigned short addr)
+{
+    unsigned char *p = sc->last;
+
+    if (p && p[0] == STA_ABS && p[1] == (unsigned char)addr && p[2] == addr >> 8) return 1;
+    if (!room(sc, 3)) return 0;
+    p = sc->pc;
+    p[0] = STA_ABS;
+    p[1] = addr;
+    p[2] = addr >> 8;
+    sc->last = p;
+    sc->pc = p + 3;
+    finish(sc);
+    return 1;
+}
+
+unsigned char speedcode_fill(speedcode_s *sc, unsigned short addr, unsigned char value,
+                             unsigned short len)
+{
+    unsigned char *p, *loop;
+    unsigned char pages, n, rem;
+
+    pages = len >> 8;
+    rem = len;
+    // lda, a loop (ldx, inx, bne) per FILL_PAGES pages with a sta per page,
+    // and a loop of one sta for the rest
+    if (!room(sc, 2 + (pages + FILL_PAGES - 1) / FILL_PAGES * 5 + pages * 3 + (rem ? 8 : 0)))
+        return 0;
+    p = sc->pc;
+    *p++ = LDA_IMM;
+    *p++ = value;
+    while (pages) {
+        n = (pages < FILL_PAGES) ? pages : FILL_PAGES;
+        pages -= n;
+        *p++ = LDX_IMM;
+        *p++ = 0;
+        loop = p;
+        do {
+            *p++ = STA_ABSX;
+            *p++ = addr;
+            *p++ = addr >> 8;
+            addr += 0x100;
+        } while (--n);
+        *p++ = INX;
+        *p++ = BNE;
+        *p = loop - (p + 1);
+        ++p;
+    }
+    // the rest, with x counting up from 256 - rem to 0
+    if (rem) {
+        addr += rem - 0x100;
+        *p++ = LDX_IMM;
+        *p++ = -rem;
+        *p++ = STA_ABSX;
+        *p++ = addr;
+        *p++ = addr >> 8;
+        *p++ = INX;
+        *p++ = BNE;
+        *p++ = -6;
+    }
+    sc->pc = p;
+    sc->last = NULL;
+    finish(sc);
+    return 1;
+}
+
+unsigned char speedcode_and(speedcode_s *sc, unsigned short addr, unsigned char mask)
+{
+    unsigned char *p = sc->last;
+    unsigned char lo = addr, hi = addr >> 8;
+
+    // same byte as the last one, clear more of its bits
+    if (p && p[0] == LDA_ABS && p[1] == lo && p[2] == hi) {
+        p[4] &= mask;
+        return 1;
+    }
+    if (!room(sc, CLOSE_SIZE + OPEN_SIZE + 8)) return 0;
+    p = sc->pc;
+    // close a full group, to let interrupts in
+    if (sc->run == SPEEDCODE_RUN) {
+        p[0] = PLA;
+        p[1] = STA_ZP;
+        p[2] = 0x01;
+        p[3] = PLP;
+        p += CLOSE_SIZE;
+        sc->run = 0;
+    }
+    // open a group: interrupts off, all RAM (as ENABLE_HIMEM)
+    if (!sc->run) {
+        p[0] = PHP;
+        p[1] = SEI;
+        p[2] = LDA_ZP;
+        p[3] = 0x01;
+        p[4] = PHA;
+        p[5] = AND_IMM;
+        p[6] = 0xf8;
+        p[7] = STA_ZP;
+        p[8] = 0x01;
+        p += OPEN_SIZE;
+    }
+    p[0] = LDA_ABS;
+    p[1] = lo;
+    p[2] = hi;
+    p[3] = AND_IMM;
+    p[4] = mask;
+    p[5] = STA_ABS;
+    p[6] = lo;
+    p[7] = hi;
+    sc->last = p;
+    sc->pc = p + 8;
+    ++sc->run;
+    finish(sc);
+    return 1;
+}
+
+void speedcode_run(speedcode_s *sc)
+{
+#ifdef __CC65__
+    ((void (*)(void))sc->start)();
+#else
+    // no 6502 to run it on (host build), so step through it instead
+    unsigned char *p = sc->start;
+    unsigned char a = 0, x = 0, s = 0;
+    unsigned char stack[4];
+
+    for (;;) {
+        switch (*p) {
+            case LDA_IMM: a = p[1]; p += 2; break;
+            case LDA_ZP: a = PEEK(p[1]); p += 2; break;
+            case LDA_ABS: a = PEEK(p[1] | p[2] << 8); p += 3; break;
+            case AND_IMM: a &= p[1]; p += 2; break;
+            case STA_ZP: POKE(p[1], a); p += 2; break;
+            case STA_ABS: POKE(p[1] | p[2] << 8, a); p += 3; break;
+            case STA_ABSX: POKE((unsigned short)((p[1] | p[2] << 8) + x), a); p += 3; break;
+            case LDX_IMM: x = p[1]; p += 2; break;
+            case INX: ++x; ++p; break;
+            case BNE: p += 2; if (x) p += (signed char)p[-1]; break;
+            case PHA: stack[s++] = a; ++p; break;
+            case PLA: a = stack[--s]; ++p; break;
+            case PHP: case PLP: case SEI: ++p; break;
+            default: return;
+        }
+    }
+#endif
+}
@@ -0,0 +1,68 @@
+/**
+ * Speedcode
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * Unrolled 6502 code written into a buffer at run time: fills made of one
+ * sta abs,x per page, and lists of stores or read-modify-writes to erase
+ * what was drawn, with no index or branch overhead. The code always ends in
+ * rts, so it can be run at any time.
+ */
+
+#ifndef _SPEEDCODE_H
+#define _SPEEDCODE_H
+
+// read-modify-writes per group with the ROM banked out and interrupts off
+#ifndef SPEEDCODE_RUN
+#define SPEEDCODE_RUN 16
+#endif
+
+// bytes of code for a load and up to n stores (speedcode_store)
+#define SPEEDCODE_STORE_SIZE(n) ((n) * 3 + 7)
+
+// bytes of code for up to n read-modify-writes (speedcode_and)
+#define SPEEDCODE_AND_SIZE(n) ((n) * 9 + 32)
+
+// generated code
+typedef struct {
+    unsigned char *start;               // first instruction
+    unsigned char *pc;                  // end of the instructions (the closing code)
+    unsigned char *end;                 // end of the buffer
+    unsigned char *last;                // last store or read-modify-write, to merge into
+    unsigned char run;                  // read-modify-writes in the open group, 0 if none
+    unsigned char full;                 // something did not fit since the last reset
+} speedcode_s;
+
+///// FUNCTIONS /////
+
+// start empty code in the size bytes at buf
+void speedcode_init(speedcode_s *sc, void *buf, unsigned short size);
+
+// empty the code
+void speedcode_reset(speedcode_s *sc);
+
+// bytes of code, including the closing rts
+unsigned short speedcode_size(speedcode_s *sc);
+
+// each of these adds to the code, and returns 1, or 0 (and sets full) if the
+// buffer has no room
+
+// lda #value
+unsigned char speedcode_load(speedcode_s *sc, unsigned char value);
+
+// sta addr (nothing if the last instruction stored to addr too)
+unsigned char speedcode_store(speedcode_s *sc, unsigned short addr);
+
+// fill len bytes at addr with value, a sta abs,x per page (uses A and X)
+unsigned char speedcode_fill(speedcode_s *sc, unsigned short addr, unsigned char value,
+                             unsigned short len);
+
+// lda addr / and #mask / sta addr, with the ROM banked out so it can read
+// under it (merged into the last one if that was at addr too, uses A)
+unsigned char speedcode_and(speedcode_s *sc, unsigned short addr, unsigned char mask);
+
+// run the code
+void speedcode_run(speedcode_s *sc);
+
+#endif
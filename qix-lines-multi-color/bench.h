@@ -0,0 +1,42 @@
+/**
+ * Benchmark
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _BENCH_H
+#define _BENCH_H
+
+// emulated seconds a benchmark build runs for
+#ifndef BENCH_SECONDS
+#define BENCH_SECONDS 30
+#endif
+
+// result block in the tape buffer: count (4 bytes), tenths of a second (2 bytes),
+// jiffies from power on to bench_start (4 bytes)
+#define BENCH_RESULT 0x033c
+
+// count one unit of work (generation, line, run)
+#define BENCH_COUNT() (++bench_count)
+
+extern unsigned long bench_count;
+
+///// FUNCTIONS /////
+
+// start benchmark clock (CIA1 time of day clock), and note how long it took
+// to get here (jiffy clock, so it includes loading and unpacking)
+void bench_start(void);
+
+// return tenths of a second since bench_start
+unsigned bench_tenths(void);
+
+// return true once BENCH_SECONDS have passed
+unsigned char bench_done(void);
+
+// store result at BENCH_RESULT, print "name unit count tenths jiffies" to the
+// printer (device 4) and exit VICE through the debug cartridge
+// (the KERNAL must be banked in)
+void bench_report(const char *name, const char *unit);
+
+#endif
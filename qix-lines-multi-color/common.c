@@ -1,13 +1,171 @@
 // Source: https://8bitworkshop.com/
 
+#include <6502.h>
+
 #include "common.h"
 
-void raster_wait(byte line) {
-  while (VIC.rasterline < line) ;
+#define RASTER_STACK_SIZE 128
+
+volatile word frame_count;
+
+// raster irq callbacks, sorted by line
+static word rcb_line[MAX_RASTER_CBS];
+static raster_cb rcb_fn[MAX_RASTER_CBS];
+static byte rcb_count;
+static byte rcb_next;
+
+// callback running now, and one asking to run again at rcb_again_line
+static raster_cb rcb_current;
+static raster_cb rcb_again;
+static word rcb_again_line;
+
+static bool raster_running;
+static word frame_last;
+static byte raster_stack[RASTER_STACK_SIZE];
+
+// current raster line (9 bits)
+static word raster_line() {
+  return VIC.rasterline | ((VIC.ctrl1 & 0x80) << 1);
+}
+
+// set raster line for the next irq (9 bits)
+static void raster_compare(word line) {
+  VIC.rasterline = line;
+  if (line & 0x100)
+    VIC.ctrl1 |= 0x80;
+  else
+    VIC.ctrl1 &= 0x7f;
+}
+
+static void frame_tick(void) {
+  ++frame_count;
+}
+
+static byte raster_irq(void) {
+  raster_cb fn;
+  word line;
+
+  // not a raster interrupt, pass it on to the KERNAL
+  if (!(VIC.irr & 0x01)) return IRQ_NOT_HANDLED;
+  VIC.irr = 0x01;
+
+  for (;;) {
+    // the repeat runs first if its line comes first (or is the same, then the
+    // callback runs next time round), or if the rest are in the next frame
+    if (rcb_again && (rcb_next == 0 || rcb_again_line <= rcb_line[rcb_next])) {
+      fn = rcb_again;
+      rcb_again = NULL;
+    } else {
+      fn = rcb_fn[rcb_next];
+      if (++rcb_next >= rcb_count) rcb_next = 0;
+    }
+    rcb_current = fn;
+    fn();
+    // earlier of the next callback and a pending repeat (kept until it runs)
+    if (rcb_again && (rcb_next == 0 || rcb_again_line <= rcb_line[rcb_next]))
+      line = rcb_again_line;
+    else
+      line = rcb_line[rcb_next];
+    raster_compare(line);
+    // wait for the irq unless the line was passed while running this one
+    if ((rcb_next == 0 && !rcb_again) || line > raster_line() + 1) break;
+  }
+  return IRQ_HANDLED;
+}
+
+void raster_start() {
+  if (raster_running) return;
+  raster_add(RASTER_VBLANK, frame_tick);
+  frame_last = frame_count;
+  rcb_next = 0;
+  rcb_again = NULL;
+  asm("sei");
+  set_irq(raster_irq, raster_stack, sizeof(raster_stack));
+  raster_compare(rcb_line[0]);
+  VIC.irr = 0x01;
+  VIC.imr |= 0x01;
+  raster_running = true;
+  asm("cli");
+}
+
+void raster_stop() {
+  if (!raster_running) return;
+  asm("sei");
+  VIC.imr &= ~0x01;
+  VIC.irr = 0x01;
+  reset_irq();
+  raster_running = false;
+  asm("cli");
+  raster_remove(frame_tick);
+}
+
+bool raster_add(word line, raster_cb fn) {
+  byte i;
+
+  if (rcb_count >= MAX_RASTER_CBS) return false;
+  asm("php");
+  asm("sei");
+  // insert sorted by line
+  for (i = rcb_count; i > 0 && rcb_line[i - 1] > line; --i) {
+    rcb_line[i] = rcb_line[i - 1];
+    rcb_fn[i] = rcb_fn[i - 1];
+  }
+  rcb_line[i] = line;
+  rcb_fn[i] = fn;
+  ++rcb_count;
+  if (i < rcb_next) {
+    ++rcb_next;
+  } else if (i == rcb_next && raster_running) {
+    raster_compare(line);
+  }
+  asm("plp");
+  return true;
+}
+
+void raster_remove(raster_cb fn) {
+  byte i, j;
+
+  asm("php");
+  asm("sei");
+  for (i = 0; i < rcb_count && rcb_fn[i] != fn; ++i) ;
+  if (i < rcb_count) {
+    --rcb_count;
+    for (j = i; j < rcb_count; ++j) {
+      rcb_line[j] = rcb_line[j + 1];
+      rcb_fn[j] = rcb_fn[j + 1];
+    }
+    if (i < rcb_next) --rcb_next;
+    if (rcb_next >= rcb_count) rcb_next = 0;
+    if (rcb_again == fn) rcb_again = NULL;
+    if (raster_running) raster_compare(rcb_line[rcb_next]);
+  }
+  asm("plp");
+}
+
+void raster_again(word line) {
+  rcb_again = rcb_current;
+  rcb_again_line = line;
+}
+
+void wait_frames(byte frames) {
+  while ((word)(frame_count - frame_last) < frames) ;
+  frame_last = frame_count;
 }
 
 void wait_vblank(void) {
-  raster_wait(255);
+  word f;
+
+#ifndef __CC65__
+  // no raster to wait for (host build)
+  return;
+#endif
+  // no scheduler, watch the raster line instead
+  if (!raster_running) {
+    while (VIC.rasterline < 255) ;
+    return;
+  }
+  f = frame_count;
+  while (frame_count == f) ;
 }
 
 static byte VIC_BANK_PAGE[4] = {
@@ -15,14 +173,145 @@ static byte VIC_BANK_PAGE[4] = {
 };
 
 char *get_vic_bank_start() {
-  return (char *)(VIC_BANK_PAGE[CIA2.pra & 3] << 8);
+  return (char *)MEMPTR(VIC_BANK_PAGE[CIA2.pra & 3] << 8);
 }
 
 char *get_screen_memory() {
   return ((VIC.addr & 0xf0) << 6) + get_vic_bank_start();
 }
 
+#ifdef KERNAL_OFF
+
+// keyboard matrix, by column (CIA1 port A) then row (CIA1 port B)
+// shift, control and commodore keys are 0
+static const char KEYMAP[64] = {
+  0x14, '\n', 0x1d, 0x88, 0x85, 0x86, 0x87, 0x11,
+  '3',  'w',  'a',  '4',  'z',  's',  'e',  0,
+  '5',  'r',  'd',  '6',  'c',  'f',  't',  'x',
+  '7',  'y',  'g',  '8',  'b',  'h',  'u',  'v',
+  '9',  'i',  'j',  '0',  'm',  'k',  'o',  'n',
+  '+',  'p',  'l',  '-',  '.',  ':',  '@',  ',',
+  0x5c, '*',  ';',  0x13, 0,    '=',  0x5e, '/',
+  '1',  0x5f, 0,    '2',  ' ',  0,    'q',  0x03
+};
+
+// matrix code held down at the last scan (0xff for none)
+static byte key_down = 0xff;
+// key pressed since it was last read
+static char key_pending;
+
+// scan keyboard matrix and note a newly pressed key
+static void key_scan() {
+  byte col, rows, row, code;
+
+  code = 0xff;
+  asm("php");
+  asm("sei");
+  // any key at all?
+  CIA1.pra = 0x00;
+  if (CIA1.prb != 0xff) {
+    for (col = 0; col < 8; ++col) {
+      CIA1.pra = ~(1 << col);
+      rows = ~CIA1.prb;
+      for (row = 0; rows; ++row, rows >>= 1)
+        if ((rows & 1) && KEYMAP[(col << 3) | row])
+          code = (col << 3) | row;
+    }
+  }
+  // leave the stop key column selected, like the KERNAL
+  CIA1.pra = 0x7f;
+  asm("plp");
+  if (code != key_down) {
+    if (code != 0xff) key_pending = KEYMAP[code];
+    key_down = code;
+  }
+}
+
+bool key_hit() {
+  key_scan();
+  return key_pending != 0;
+}
+
+char key_get() {
+  char c;
+
+  while (!(c = poll_keyboard())) ;
+  return c;
+}
+
+char __fastcall__ poll_keyboard() {
+  char c;
+
+  key_scan();
+  c = key_pending;
+  key_pending = 0;
+  return c;
+}
+
+#else
+
 char __fastcall__ poll_keyboard() {
   asm("jmp $f142");
   return __A__;
 }
+
+#endif
+
+static void kernal_irq_exit(void);
+
+// IRQ entry while the KERNAL is banked out
+// bank it in, push the registers like the KERNAL's own entry and go through
+// the IRQ vector at 0x314 (and the cc65 irq chain), which returns to
+// kernal_irq_exit to restore the banking
+static void kernal_irq(void) {
+  asm("pha");
+  asm("lda $01");
+  asm("pha");
+  asm("lda #>%v", kernal_irq_exit);
+  asm("pha");
+  asm("lda #<%v", kernal_irq_exit);
+  asm("pha");
+  asm("lda #$04");
+  asm("pha");
+  asm("pha");
+  asm("txa");
+  asm("pha");
+  asm("tya");
+  asm("pha");
+  asm("lda #$36");
+  asm("sta $01");
+  asm("jmp ($0314)");
+}
+
+static void kernal_irq_exit(void) {
+  asm("pla");
+  asm("sta $01");
+  asm("pla");
+  asm("rti");
+}
+
+// NMI while the KERNAL is banked out (RESTORE key), ignore it
+static void kernal_nmi(void) {
+  asm("rti");
+}
+
+void kernal_off() {
+  asm("sei");
+  // stop the KERNAL's timer irq (keyboard and clock)
+  CIA1.icr = 0x7f;
+  asm("lda $dc0d");
+  // hardware vectors, in the RAM under the KERNAL
+  POKEW(0xfffa, (word)kernal_nmi);
+  POKEW(0xfffe, (word)kernal_irq);
+  // RAM at 0xa000-0xbfff and 0xe000-0xffff, I/O at 0xd000-0xdfff
+  POKE(1, (PEEK(1) & ~0b111) | 0b101);
+  asm("cli");
+}
+
+void kernal_on() {
+  asm("sei");
+  // KERNAL and I/O back, BASIC stays out (see DISABLE_HIMEM)
+  POKE(1, (PEEK(1) & ~0b111) | 0b110);
+  CIA1.icr = 0x81;
+  asm("cli");
+}
@@ -20,13 +20,28 @@ typedef enum { false, true } bool;      // boolean
 #define COLS 40                         // total # of columns
 #define ROWS 25                         // total # of rows
 
+// max raster irq callbacks (including the frame counter)
+#ifndef MAX_RASTER_CBS
+#define MAX_RASTER_CBS 8
+#endif
+
+#define RASTER_VBLANK 251               // first raster line below the display
+
+// raster irq callback
+typedef void (*raster_cb)(void);
+
 ///// MACROS /////
 
+// pointer to C64 memory at addr (the host shim maps this to its memory array)
+#ifndef MEMPTR
+#define MEMPTR(addr) ((void *)(addr))
+#endif
+
 // lookup screen address macro
 #define SCRNADR(base, col, row) ((base) + (col) + (row) * 40)
 
 // default screen base address on startup
-#define DEFAULT_SCREEN ((void*) 0x400)
+#define DEFAULT_SCREEN MEMPTR(0x400)
 
 // wait until next frame, same as waitvsync()
 #define wait_vblank waitvsync
@@ -52,21 +67,58 @@ typedef enum { false, true } bool;      // boolean
 #define SET_SCROLL_X(_x) \
   VIC.ctrl2 = (VIC.ctrl2 & 0xf8) | (_x);
 
+#ifdef KERNAL_OFF
+
+// BASIC and KERNAL are banked out by kernal_off(), RAM is always visible
+#define ENABLE_HIMEM()
+#define DISABLE_HIMEM()
+
+// read the keyboard matrix instead of the KERNAL keyboard buffer
+#define kbhit key_hit
+#define cgetc key_get
+
+#else
+
 // enable RAM from 0xa000-0xffff, disable interrupts
 #define ENABLE_HIMEM() \
   asm("php"); \
   asm("sei"); \
   POKE(1, PEEK(1) & ~0b111);
 
-// enable ROM and interrupts
+// enable KERNAL and I/O (BASIC stays out, as the startup left it, for the
+// buffers in the RAM under it) and interrupts
 #define DISABLE_HIMEM() \
-  POKE(1, PEEK(1) | 0b111); \
+  POKE(1, (PEEK(1) & ~0b111) | 0b110); \
   asm("plp");
 
+#endif
+
+///// GLOBALS /////
+
+// frames since raster_start, counted at RASTER_VBLANK
+extern volatile word frame_count;
+
 ///// FUNCTIONS /////
 
-// wait until specific raster line
-void raster_wait(byte line);
+// start raster irq scheduler
+void raster_start();
+
+// stop raster irq scheduler (callbacks are kept)
+void raster_stop();
+
+// call fn from the raster irq at line (0-311) every frame
+// return false if there is no room
+bool raster_add(word line, raster_cb fn);
+
+// remove raster irq callback
+void raster_remove(raster_cb fn);
+
+// from a callback, call it again at a later line in the same frame
+void raster_again(word line);
+
+// wait until frames have passed since the last call, to pace a loop
+// (return at once if they already have)
+void wait_frames(byte frames);
 
 // get current VIC bank start address
 char *get_vic_bank_start();
@@ -75,6 +127,27 @@ char *get_vic_bank_start();
 char *get_screen_memory();
 
 // return key in buffer, or 0 if none (BIOS call)
+// with KERNAL_OFF, return newly pressed key from the keyboard matrix
 char __fastcall__ poll_keyboard();
 
+#ifdef KERNAL_OFF
+
+// scan keyboard matrix, return true if a key was pressed since the last read
+// (kbhit, which needs the KERNAL, is mapped to it)
+bool key_hit();
+
+// wait for a key press on the keyboard matrix and return it (unshifted)
+// (cgetc is mapped to it)
+char key_get();
+
+#endif
+
+// bank out BASIC and KERNAL (RAM at 0xa000-0xbfff and 0xe000-0xffff, I/O
+// stays in), install RAM IRQ/NMI handlers, and stop the KERNAL's timer irq
+// ROM calls (including conio output) must not be used until kernal_on()
+void kernal_off();
+
+// bank BASIC and KERNAL back in and restart the KERNAL's timer irq
+void kernal_on();
+
 #endif
@@ -0,0 +1,59 @@
+/**
+ * Machine Capabilities
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _MACHINE_H
+#define _MACHINE_H
+
+#include <c64.h>
+#include <peekpoke.h>
+
+// pointer to C64 memory at addr (see common.h)
+#ifndef MEMPTR
+#define MEMPTR(addr) ((void *)(addr))
+#endif
+
+// shortest block worth setting up a REU transfer for
+#define REU_MIN_LENGTH 32
+
+// capabilities
+typedef struct {
+    unsigned char tv;                   // TV_PAL, TV_NTSC or TV_OTHER
+    unsigned short lines;               // raster lines per frame
+    unsigned short reu_banks;           // 64K banks in the REU, 0 if none
+    unsigned char scpu;                 // SuperCPU (20 MHz)
+    unsigned char c128;                 // C128 in C64 mode (2 MHz with no display)
+} machine_s;
+
+extern machine_s machine;
+
+///// MACROS /////
+
+// C128 2 MHz mode, only while the VIC is not fetching (border, blanked screen)
+#define C128_FAST() (VIC.clock = 1)
+#define C128_SLOW() (VIC.clock = 0)
+
+// clear len bytes at p, with the REU if there is one
+#define fast_clear(p, len) fast_fill(p, 0, len)
+
+///// FUNCTIONS /////
+
+// fill in machine (overwrites the start of each REU bank)
+void machine_detect(void);
+
+// SuperCPU turbo on or off (nothing on other machines)
+void machine_turbo(unsigned char on);
+
+// block operations in C64 memory, with the REU if there is one (using the
+// start of bank 0), or the CPU if not
+
+// fill len bytes at p with value
+void fast_fill(void *p, unsigned char value, unsigned short len);
+
+// copy len bytes from src to dst (which may overlap, like memmove)
+void fast_copy(void *dst, const void *src, unsigned short len);
+
+#endif
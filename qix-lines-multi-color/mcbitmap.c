@@ -1,22 +1,63 @@
 // Source: https://8bitworkshop.com/
 
 #include "common.h"
+#include "machine.h"
 #include "mcbitmap.h"
 
+// code that erases what draw_line draws, if recording
+static speedcode_s *erase_rec;
+
+// erase pixels under mask (0 bits) at ofs, if recording
+#define RECORD(ofs, mask) if (erase_rec) speedcode_and(erase_rec, ofs, mask);
+
 void setup_bitmap_multi() {
+    byte code[160];
+    speedcode_s sc;
+
     VIC.ctrl1 = 0x38;
     VIC.ctrl2 = 0x18;
     SET_VIC_BANK(MCB_BITMAP);
     SET_VIC_BITMAP(MCB_BITMAP);
     SET_VIC_SCREEN(MCB_COLORS);
-    memset((void *)MCB_BITMAP, 0, 0x2000);
-    memset((void *)MCB_COLORS, 0, 0x800);
-    memset(COLOR_RAM, 0, 40*25);
+    // without a REU, unrolled fills (a sta abs,x per page) beat memset
+    speedcode_init(&sc, code, sizeof(code));
+    speedcode_fill(&sc, MCB_BITMAP, 0, 0x2000);
+    speedcode_fill(&sc, MCB_COLORS, 0, 0x800);
+    speedcode_fill(&sc, 0xd800, 0, 40*25);
+    if (machine.reu_banks || sc.full) {
+        fast_clear(MEMPTR(MCB_BITMAP), 0x2000);
+        fast_clear(MEMPTR(MCB_COLORS), 0x800);
+        fast_clear(COLOR_RAM, 40*25);
+    } else {
+        speedcode_run(&sc);
+    }
+}
+
+void record_erase(speedcode_s *sc) {
+    erase_rec = sc;
 }
 
 const byte PIXMASK[4] = { ~0xc0, ~0x30, ~0x0c, ~0x03 };
 const byte PIXSHIFT[4] = { 6, 4, 2, 0 };
 
+// 2-bit color value repeated across all 4 pixels of a byte
+const byte PIXFILL[4] = { 0x00, 0x55, 0xaa, 0xff };
+
+// pixels from x & 3 to the right/left end of a byte
+const byte LEFTMASK[4] = { 0xff, 0x3f, 0x0f, 0x03 };
+const byte RIGHTMASK[4] = { 0xc0, 0xf0, 0xfc, 0xff };
+
+// bitmap byte holding pixel x, given the address of column 0 on its row
+#define ROW_BYTE(ofs, x) PEEK((ofs) + (((word)(x) >> 2) << 3))
+
+// pixel value of x, given the address of column 0 on its row
+#define ROW_PIXEL(ofs, x) (ROW_BYTE(ofs, x) & ~PIXMASK[(x) & 3])
+
+// bitmap address of column 0 on row y
+static word row_address(byte y) {
+    return ((y >> 3) * 320) | (y & 7) | MCB_BITMAP;
+}
+
 byte is_pixel(byte x, byte y) {
     word ofs = ((x >> 2) * 8 + (y >> 3) * 320) | (y & 7) | MCB_BITMAP;
     byte pixvalue;
@@ -26,50 +67,46 @@ byte is_pixel(byte x, byte y) {
     return pixvalue & ~PIXMASK[x & 3];;
 }
 
+// find or allocate color in the 4x8 cell at cx, cy and return its pixel value
+static byte cell_color(byte cx, byte cy, byte color) {
+    word cram, sram;
+    byte scol, used;
+
+    // equal to background color? (value 0)
+    if (color == (VIC.bgcolor0 & 0xf)) return 0;
+
+    // calculate character (and color RAM) offset
+    cram = cx + cy * 40;
+    sram = cram | MCB_COLORS;
+    cram |= 0xd800;
+    // read screen memory and used bits (always RAM)
+    scol = PEEK(sram);
+    used = PEEK(sram | 0x400);
+    // unused in lower nibble of screen RAM? (value 2)
+    if (color == (scol & 0xf) || !(used & 0x10)) {
+        POKE(sram, (scol & 0xf0) | color);
+        POKE(sram | 0x400, used | 0x10);
+        return 2;
+    }
+    // unused in upper nibble of screen RAM? (value 1)
+    if (color == (scol >> 4) || !(used & 0x20)) {
+        POKE(sram, (scol & 0xf) | (color << 4));
+        POKE(sram | 0x400, used | 0x20);
+        return 1;
+    }
+    // all other colors in use, use color RAM
+    POKE(cram, color);
+    POKE(sram | 0x400, used | 0x40);
+    return 3;
+}
+
 void set_pixel(byte x, byte y, byte color) {
-    word ofs, b, cram, sram;
-    byte ccol, scol, used;
-    byte val;
+    word ofs;
+    byte b, val;
 
     if (x >= 160 || y >= 200) return;
 
-    color &= 0xf;
-    // equal to background color? (value 0)
-    if (color == VIC.bgcolor0) {
-        val = 0;
-    } else {
-        // calculate character (and color RAM) offset
-        cram = ((x >> 2) + (y >> 3) * 40);
-        sram = cram | MCB_COLORS;
-        cram |= 0xd800;
-        // read color ram, screen memory, and used bits
-        ENABLE_HIMEM();
-        ccol = PEEK(cram);
-        scol = PEEK(sram);
-        used = PEEK(sram | 0x400);
-        DISABLE_HIMEM();
-        // unused in lower nibble of screen RAM? (value 2)
-        if (color == (scol & 0xf) || !(used & 0x10)) {
-            val = 2;
-            scol = (scol & 0xf0) | color;
-            used |= 0x10;
-            POKE(sram, scol);
-            // unused in upper nibble of screen RAM? (value 1)
-        } else if (color == (scol >> 4) || !(used & 0x20)) {
-            val = 1;
-            scol = (scol & 0xf) | (color << 4);
-            used |= 0x20;
-            POKE(sram, scol);
-            // all other colors in use, use color RAM
-        } else {
-            val = 3;
-            used |= 0x40;
-            ccol = color;
-            POKE(cram, ccol);
-        }
-        // write to unused bit
-        POKE(sram | 0x400, used);
-    }
+    val = cell_color(x >> 2, y >> 3, color & 0xf);
 
     ofs = ((x >> 2) * 8 + (y >> 3) * 320) | (y & 7) | MCB_BITMAP;
     x &= 3;
@@ -82,50 +119,383 @@ void set_pixel(byte x, byte y, byte color) {
     POKE(ofs, b);
 }
 
-void draw_line(int x0, int y0, int x1, int y1, byte color) {
-    int dx = abs(x1 - x0);
-    int sx = x0 < x1 ? 1 : -1;
-    int dy = abs(y1 - y0);
-    int sy = y0 < y1 ? 1 : -1;
-    int err = (dx > dy ? dx : -dy) >> 1;
+// fill pixels x1 to x2 (inclusive) on row y, a whole byte at a time
+void fill_span(byte x1, byte x2, byte y, byte color) {
+    word ofs;
+    byte cx, cx1, cx2, cy, mask, pat, b;
+
+    if (y >= 200 || x1 >= 160 || x1 > x2) return;
+    if (x2 >= 160) x2 = 159;
+
+    color &= 0xf;
+    cy = y >> 3;
+    cx1 = x1 >> 2;
+    cx2 = x2 >> 2;
+    ofs = row_address(y) + ((word)cx1 << 3);
+    for (cx = cx1; ; ++cx, ofs += 8) {
+        pat = PIXFILL[cell_color(cx, cy, color)];
+        mask = 0xff;
+        if (cx == cx1) mask &= LEFTMASK[x1 & 3];
+        if (cx == cx2) mask &= RIGHTMASK[x2 & 3];
+        RECORD(ofs, ~mask);
+        if (mask == 0xff) {
+            // whole byte, no need to read it back
+            POKE(ofs, pat);
+        } else {
+            ENABLE_HIMEM();
+            b = PEEK(ofs);
+            DISABLE_HIMEM();
+            POKE(ofs, (b & ~mask) | (pat & mask));
+        }
+        if (cx == cx2) break;
+    }
+}
+
+// Cohen-Sutherland outcodes against the 160x200 bitmap
+#define CLIP_LEFT   1
+#define CLIP_RIGHT  2
+#define CLIP_TOP    4
+#define CLIP_BOTTOM 8
+
+static byte outcode(int x, int y) {
+    byte code = 0;
+    if (x < 0) code |= CLIP_LEFT;
+    else if (x >= 160) code |= CLIP_RIGHT;
+    if (y < 0) code |= CLIP_TOP;
+    else if (y >= 200) code |= CLIP_BOTTOM;
+    return code;
+}
+
+// clip line to the bitmap, return false if none of it is visible
+static bool clip_line(int *x0, int *y0, int *x1, int *y1) {
+    byte code0 = outcode(*x0, *y0);
+    byte code1 = outcode(*x1, *y1);
+    byte code;
+    int x, y;
+
+    for (;;) {
+        // both ends inside
+        if (!(code0 | code1)) return true;
+        // both ends on the same outside
+        if (code0 & code1) return false;
+        // move the outside end to the edge it crosses
+        code = code0 ? code0 : code1;
+        if (code & CLIP_TOP) {
+            x = *x0 + (int)((long)(*x1 - *x0) * (0 - *y0) / (*y1 - *y0));
+            y = 0;
+        } else if (code & CLIP_BOTTOM) {
+            x = *x0 + (int)((long)(*x1 - *x0) * (199 - *y0) / (*y1 - *y0));
+            y = 199;
+        } else if (code & CLIP_LEFT) {
+            y = *y0 + (int)((long)(*y1 - *y0) * (0 - *x0) / (*x1 - *x0));
+            x = 0;
+        } else {
+            y = *y0 + (int)((long)(*y1 - *y0) * (159 - *x0) / (*x1 - *x0));
+            x = 159;
+        }
+        if (code == code0) {
+            *x0 = x;
+            *y0 = y;
+            code0 = outcode(x, y);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            code1 = outcode(x, y);
+        }
+    }
+}
+
+// vertical line from y0 down to y1, one cell (8 rows) per bank switch
+static void draw_vline(byte x, byte y0, byte y1, byte color) {
+    word ofs = row_address(y0) + ((word)(x >> 2) << 3);
+    byte mask = PIXMASK[x & 3];
+    byte shift = PIXSHIFT[x & 3];
+    byte pat, y, end;
+
+    for (;;) {
+        pat = cell_color(x >> 2, y0 >> 3, color) << shift;
+        // rows in this cell, recorded before interrupts go off
+        if (erase_rec) {
+            end = (y0 | 7) < y1 ? (y0 | 7) : y1;
+            for (y = y0; y <= end; ++y) speedcode_and(erase_rec, ofs + (y - y0), mask);
+        }
+        ENABLE_HIMEM();
+        for (;;) {
+            POKE(ofs, (PEEK(ofs) & mask) | pat);
+            if (y0 == y1 || (y0 & 7) == 7) break;
+            ++y0;
+            ++ofs;
+        }
+        DISABLE_HIMEM();
+        if (y0 == y1) break;
+        ++y0;
+        ofs += 320 - 7;
+    }
+}
+
+// any other line, stepping the bitmap address along with x and y
+static void draw_dline(byte x0, byte y0, byte x1, byte y1, byte color) {
+    int dx = x0 < x1 ? x1 - x0 : x0 - x1;
+    int dy = y0 < y1 ? y1 - y0 : y0 - y1;
+    bool right = x0 < x1;
+    bool down = y0 < y1;
+    int err = (dx > dy ? dx : -dy) / 2;
     int e2;
-    for(;;) {
-        set_pixel(x0, y0, color);
+    word ofs = row_address(y0) + ((word)(x0 >> 2) << 3);
+    byte val = 0;
+    byte b;
+    bool cell = true;
+
+    for (;;) {
+        // new cell, find its color value
+        if (cell) {
+            val = cell_color(x0 >> 2, y0 >> 3, color);
+            cell = false;
+        }
+        ENABLE_HIMEM();
+        b = PEEK(ofs) & PIXMASK[x0 & 3];
+        DISABLE_HIMEM();
+        POKE(ofs, b | (val << PIXSHIFT[x0 & 3]));
+        RECORD(ofs, PIXMASK[x0 & 3]);
         if (x0 == x1 && y0 == y1) break;
         e2 = err;
-        if (e2 > -dx) { err -= dy; x0 += sx; }
-        if (e2 < dy) { err += dx; y0 += sy; }
+        if (e2 > -dx) {
+            err -= dy;
+            if (right) {
+                if ((x0 & 3) == 3) { ofs += 8; cell = true; }
+                ++x0;
+            } else {
+                if ((x0 & 3) == 0) { ofs -= 8; cell = true; }
+                --x0;
+            }
+        }
+        if (e2 < dy) {
+            err += dx;
+            if (down) {
+                if ((y0 & 7) == 7) { ofs += 320 - 7; cell = true; }
+                else ++ofs;
+                ++y0;
+            } else {
+                if ((y0 & 7) == 0) { ofs -= 320 - 7; cell = true; }
+                else --ofs;
+                --y0;
+            }
+        }
+    }
+}
+
+void draw_line(int x0, int y0, int x1, int y1, byte color) {
+    // clip once, then no per-pixel bounds checks
+    if (!clip_line(&x0, &y0, &x1, &y1)) return;
+    color &= 0xf;
+    if (y0 == y1) {
+        // horizontal, whole bytes at a time
+        if (x0 < x1) fill_span(x0, x1, y0, color);
+        else fill_span(x1, x0, y0, color);
+    } else if (x0 == x1) {
+        if (y0 < y1) draw_vline(x0, y0, y1, color);
+        else draw_vline(x0, y1, y0, color);
+    } else {
+        draw_dline(x0, y0, x1, y1, color);
+    }
+}
+
+// pending flood fill seeds
+static byte fill_x[FILL_STACK_SIZE];
+static byte fill_y[FILL_STACK_SIZE];
+static byte fill_sp;
+static bool fill_overflow;
+
+// push a flood fill seed, or note that one was dropped
+#define FILL_PUSH(_x, _y) \
+    if (fill_sp < FILL_STACK_SIZE) { \
+        fill_x[fill_sp] = (_x); \
+        fill_y[fill_sp++] = (_y); \
+    } else { \
+        fill_overflow = true; \
+    }
+
+// push a seed for each run of empty pixels from x1 to x2 on row y
+static void push_runs(byte x1, byte x2, byte y) {
+    word ofs = row_address(y);
+    byte x = x1;
+    bool run = false;
+
+    ENABLE_HIMEM();
+    while (x <= x2) {
+        // whole empty byte, test 4 pixels at once
+        if ((x & 3) == 0 && x + 3 <= x2 && ROW_BYTE(ofs, x) == 0) {
+            if (!run) {
+                FILL_PUSH(x, y);
+                run = true;
+            }
+            x += 4;
+            continue;
+        }
+        if (ROW_PIXEL(ofs, x)) {
+            run = false;
+        } else if (!run) {
+            FILL_PUSH(x, y);
+            run = true;
+        }
+        ++x;
     }
+    DISABLE_HIMEM();
 }
 
-// support recursion
-#pragma static-locals(push,off)
+// fill the empty region containing (x, y) with color
+// return 1 if done, or 0 if the seed stack overflowed and the fill is partial
 byte flood_fill(byte x, byte y, byte color) {
-    register byte x1 = x;
-    register byte x2;
-    register byte i;
-    // find left edge
-    while (!is_pixel(x1, y))
-        --x1;
-    // exit if (x,y) is on a boundary
-    if (x1 == x)
-        return 1;
-    ++x1;
-    // find right edge
-    x2 = x + 1;
-    while (!is_pixel(x2, y))
-        ++x2;
-    // fill scanline
-    for (i = x1; i < x2; i++) {
-        set_pixel(i, y, color);
+    word ofs;
+    byte x1, x2;
+
+    if (x >= 160 || y >= 200) return 1;
+    // filling with the background color would never terminate
+    if ((color & 0xf) == (VIC.bgcolor0 & 0xf)) return 1;
+
+    fill_sp = 0;
+    fill_overflow = false;
+    FILL_PUSH(x, y);
+    while (fill_sp) {
+        --fill_sp;
+        x = fill_x[fill_sp];
+        y = fill_y[fill_sp];
+        ofs = row_address(y);
+        ENABLE_HIMEM();
+        // already filled from another seed?
+        if (ROW_PIXEL(ofs, x)) {
+            DISABLE_HIMEM();
+            continue;
+        }
+        // find left edge
+        x1 = x;
+        while (x1 > 0) {
+            if ((x1 & 3) == 0 && ROW_BYTE(ofs, x1 - 1) == 0)
+                x1 -= 4;
+            else if (!ROW_PIXEL(ofs, x1 - 1))
+                --x1;
+            else
+                break;
+        }
+        // find right edge
+        x2 = x;
+        while (x2 < 159) {
+            if ((x2 & 3) == 3 && ROW_BYTE(ofs, x2 + 1) == 0)
+                x2 += 4;
+            else if (!ROW_PIXEL(ofs, x2 + 1))
+                ++x2;
+            else
+                break;
+        }
+        DISABLE_HIMEM();
+        // fill scanline
+        fill_span(x1, x2, y, color);
+        // seed empty runs above and below scanline
+        if (y > 0)
+            push_runs(x1, x2, y - 1);
+        if (y < 199)
+            push_runs(x1, x2, y + 1);
     }
-    // fill above and below scanline
-    for (i = x1; i < x2;) {
-        i += flood_fill(i, y - 1, color);
+    return !fill_overflow;
+}
+
+// polygon edge, stepped down one row at a time
+typedef struct {
+    byte y;                             // first row
+    byte ymax;                          // row after the last
+    int x;                              // x on current row, rounded up
+    int step;                           // whole pixels per row
+    int rem;                            // remaining fraction per row, in 1/dy
+    int err;                            // accumulated fraction, in 1/dy
+    int dy;
+} edge_s;
+
+static edge_s poly_edge[POLY_MAX_VERTICES];
+static byte poly_active[POLY_MAX_VERTICES];
+
+// fill polygon with vertices v (even-odd rule), one span per edge pair per row
+// pixels on the right and bottom edges are left out, so polygons that share
+// an edge don't overlap
+bool fill_polygon(const vertex_s *v, byte count, byte color) {
+    edge_s *e;
+    edge_s t;
+    byte i, j, n, na, next, y, ybot, a;
+    int dx, x;
+
+    if (count > POLY_MAX_VERTICES) return false;
+
+    // build edge table, skipping horizontal edges
+    n = 0;
+    ybot = 0;
+    for (i = 0; i < count; ++i) {
+        const vertex_s *va = &v[i];
+        const vertex_s *vb = &v[i + 1 == count ? 0 : i + 1];
+        if (va->y == vb->y) continue;
+        if (va->y > vb->y) {
+            const vertex_s *vt = va;
+            va = vb;
+            vb = vt;
+        }
+        e = &poly_edge[n++];
+        e->y = va->y;
+        e->ymax = vb->y;
+        e->x = va->x;
+        e->dy = vb->y - va->y;
+        e->err = 0;
+        // floor division, so the remainder is never negative
+        dx = vb->x - va->x;
+        if (dx >= 0)
+            e->step = dx / e->dy;
+        else
+            e->step = -((e->dy - 1 - dx) / e->dy);
+        e->rem = dx - e->step * e->dy;
+        if (vb->y > ybot) ybot = vb->y;
     }
-    for (i = x1; i < x2;) {
-        i += flood_fill(i, y + 1, color);
+    if (ybot > 200) ybot = 200;
+
+    // sort edge table by first row
+    for (i = 1; i < n; ++i) {
+        t = poly_edge[i];
+        for (j = i; j > 0 && poly_edge[j - 1].y > t.y; --j)
+            poly_edge[j] = poly_edge[j - 1];
+        poly_edge[j] = t;
+    }
+
+    na = 0;
+    next = 0;
+    for (y = n ? poly_edge[0].y : ybot; y < ybot; ++y) {
+        // drop edges that ended on the previous row
+        for (i = j = 0; i < na; ++i)
+            if (poly_edge[poly_active[i]].ymax != y)
+                poly_active[j++] = poly_active[i];
+        na = j;
+        // add edges that start on this row
+        while (next < n && poly_edge[next].y == y)
+            poly_active[na++] = next++;
+        // sort active edges by x (order rarely changes between rows)
+        for (i = 1; i < na; ++i) {
+            a = poly_active[i];
+            x = poly_edge[a].x;
+            for (j = i; j > 0 && poly_edge[poly_active[j - 1]].x > x; --j)
+                poly_active[j] = poly_active[j - 1];
+            poly_active[j] = a;
+        }
+        // fill between each pair of edges
+        for (i = 0; i + 1 < na; i += 2) {
+            x = poly_edge[poly_active[i + 1]].x;
+            if (x > poly_edge[poly_active[i]].x)
+                fill_span(poly_edge[poly_active[i]].x, x - 1, y, color);
+        }
+        // step active edges to the next row
+        for (i = 0; i < na; ++i) {
+            e = &poly_edge[poly_active[i]];
+            e->x += e->step;
+            e->err -= e->rem;
+            if (e->err < 0) {
+                e->err += e->dy;
+                ++e->x;
+            }
+        }
     }
-    return (x2 - x1);
+    return true;
 }
-#pragma static-locals(pop)
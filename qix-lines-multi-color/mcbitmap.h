@@ -1,16 +1,43 @@
 // Source: https://8bitworkshop.com/
 
 #include "common.h"
+#include "speedcode.h"
 
 #define MCB_COLORS 0xc000
 #define MCB_BITMAP 0xe000
 
+// max pending seeds for flood_fill (up to 255, two bytes each)
+#ifndef FILL_STACK_SIZE
+#define FILL_STACK_SIZE 128
+#endif
+
+// max vertices for fill_polygon (it draws nothing and returns false for more)
+#ifndef POLY_MAX_VERTICES
+#define POLY_MAX_VERTICES 32
+#endif
+
+// polygon vertex
+typedef struct {
+    byte x;
+    byte y;
+} vertex_s;
+
 void setup_bitmap_multi();
 
 byte is_pixel(byte x, byte y);
 
 void set_pixel(byte x, byte y, byte color);
 
+void fill_span(byte x1, byte x2, byte y, byte color);
+
 void draw_line(int x0, int y0, int x1, int y1, byte color);
 
+// add code to sc that erases each pixel draw_line draws from now on (back to
+// the background color), or stop if sc is NULL
+void record_erase(speedcode_s *sc);
+
 byte flood_fill(byte x, byte y, byte color);
+
+// fill the polygon through count vertices (the last joined to the first),
+// or return false if there are more than POLY_MAX_VERTICES
+bool fill_polygon(const vertex_s *v, byte count, byte color);
@@ -14,20 +14,51 @@
 #include <stdlib.h>
 #include <tgi.h>
 
+#include "governor.h"
+#include "machine.h"
 #include "mcbitmap.h"
+#include "profile.h"
+#include "rng.h"
+#include "sprite.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
 
 #define X_SIZE       160
 #define Y_SIZE       192
 #define MAX_COLORS   16
 #define COLOR_BG     TGI_COLOR_BLACK
 #define MAX_SIN      180
-#define HISTORY_SIZE 10                 // how many lines to display at once
+#define HISTORY_SIZE 10                 // lines on screen per line drawn a frame
+#define HISTORY_RING (GOV_MAX_HISTORY + 1)  // history, and the line just drawn
 #define STEP         10                 // line spacing
 #define STEP_RANGE   9                  // spacing plus/minus range
 #define QIX_COUNT    3                  // number of qixs to display
+#define HEAD_DATA    0xc800             // qix head sprite data (after screen memory)
+#define ERASE_SIZE   0x1e00             // bytes of code to erase the lines in history
+
+// profile zones (see profile.h)
+#define PZ_NEXT   0                     // next_line
+#define PZ_DRAW   1                     // draw the new line (and record its erase code)
+#define PZ_SPRITE 2                     // move the qix heads
+#define PZ_ERASE  3                     // erase the oldest lines
+
+// C128 2 MHz window, below the lowest qix head and before the sprite irq
+#define TURBO_ON_LINE  (RASTER_VBLANK + SPRITE_HEIGHT)
+#define TURBO_OFF_LINE 8
 
 // use all colors except black (0)
-#define RANDOM_COLOR() (rand() % (MAX_COLORS - 1) + 1)
+#define RANDOM_COLOR() (RNG_RANGE8(MAX_COLORS - 1) + 1)
+
+// qix head sprite, a small diamond centered on (2, 2)
+static const byte HEAD_SHAPE[63] = {
+    0x20, 0x00, 0x00,
+    0x70, 0x00, 0x00,
+    0xf8, 0x00, 0x00,
+    0x70, 0x00, 0x00,
+    0x20, 0x00, 0x00
+};
 
 // line
 typedef struct {
@@ -38,10 +69,44 @@ typedef struct {
     byte color;
 } line_s;
 
+// line history ring, and the code to erase each line, in the RAM under BASIC
+// (see c64.cfg; 0xc000-0xc83f holds screen memory and sprites, so TABLES is
+// not used)
+#pragma bss-name (push, "GRID")
+static line_s line_history[HISTORY_RING];
+static byte erase_code[ERASE_SIZE];
+#pragma bss-name (pop)
+
+// code to erase each line in history (start is NULL if there is none)
+static speedcode_s line_erase[HISTORY_RING];
+
+// where the next line's erase code goes (after the last line's)
+static byte *erase_head = erase_code;
+
+// start code to erase a line of up to pixels pixels, at erase_head or else
+// the start of erase_code, if that is not still in use by a line in history
+static bool erase_start(speedcode_s *sc, int pixels)
+{
+    word need = SPEEDCODE_AND_SIZE(pixels);
+    byte *p = erase_head;
+    speedcode_s *old;
+    byte i;
+
+    if (p + need > erase_code + ERASE_SIZE) p = erase_code;
+    if (p + need > erase_code + ERASE_SIZE) return false;
+    for (i = 0; i < HISTORY_RING; ++i) {
+        old = &line_erase[i];
+        if (old->start && p < old->start + speedcode_size(old) && old->start < p + need)
+            return false;
+    }
+    speedcode_init(sc, p, need);
+    return true;
+}
+
 int next_degree(int degree)
 {
     // add randomly to the degree
-    int d = degree + STEP + (int)rand() % (STEP_RANGE * 2 + 1) - STEP_RANGE;
+    int d = degree + STEP + RNG_RANGE8(STEP_RANGE * 2 + 1) - STEP_RANGE;
     if (d >= MAX_SIN) d = d - MAX_SIN;
     return d;
 }
@@ -103,17 +168,30 @@ void next_line(line_s *line, line_s *line_delta, line_s *line_degree)
     }
 }
 
+static void turbo_on(void)
+{
+    C128_FAST();
+}
+
+static void turbo_off(void)
+{
+    C128_SLOW();
+}
+
 // draw lines until a key is pressed
 void draw_lines()
 {
-    line_s line, line_delta, line_degree, line_history[HISTORY_SIZE];
-    int history_index;
+    line_s line, line_delta, line_degree;
+    byte head, count, tail, n, e;
+    int dx, dy;
+    speedcode_s erase;
+    speedcode_s *old;
 
     // randomize starting values
-    line.x1 = rand() % X_SIZE;
-    line.y1 = rand() % Y_SIZE;
-    line.x2 = rand() % X_SIZE;
-    line.y2 = rand() % Y_SIZE;
+    line.x1 = RNG_RANGE(X_SIZE);
+    line.y1 = RNG_RANGE(Y_SIZE);
+    line.x2 = RNG_RANGE(X_SIZE);
+    line.y2 = RNG_RANGE(Y_SIZE);
     line.color = RANDOM_COLOR();
 
     line_delta.x1 = STEP;
@@ -121,37 +199,95 @@ void draw_lines()
     line_delta.x2 = STEP;
     line_delta.y2 = STEP;
 
-    line_degree.x1 = rand() % MAX_SIN;
-    line_degree.y1 = rand() % MAX_SIN;
-    line_degree.x2 = rand() % MAX_SIN;
-    line_degree.y2 = rand() % MAX_SIN;
-    history_index = 0;
+    line_degree.x1 = RNG_RANGE8(MAX_SIN);
+    line_degree.y1 = RNG_RANGE8(MAX_SIN);
+    line_degree.x2 = RNG_RANGE8(MAX_SIN);
+    line_degree.y2 = RNG_RANGE8(MAX_SIN);
+    head = count = 0;
+    gov_init(HISTORY_SIZE);
 
-    // loop until key-press
-    while (!kbhit()) {
-        // get next line
-        next_line(&line, &line_delta, &line_degree);
+#ifdef BENCH
+    bench_start();
+#endif
+    PROFILE_START();
 
-        // draw line
-        draw_line(line.x1, line.y1, line.x2, line.y2, line.color);
+    // loop until key-press (other than the profile keys), a frame at a time
+    for (;;) {
+        if (kbhit() && !PROFILE_KEY(cgetc())) break;
 
-        // remove from history
-        draw_line(line_history[history_index].x1, line_history[history_index].y1,
-                  line_history[history_index].x2, line_history[history_index].y2,
-                  COLOR_BG);
+        gov_start();
+        for (n = 0; n < governor.lines; ++n) {
+            // get next line
+            PROFILE_ENTER(PZ_NEXT, "next");
+            next_line(&line, &line_delta, &line_degree);
+            PROFILE_EXIT(PZ_NEXT);
 
-        // add to history
-        line_history[history_index++] = line;
-        if (history_index >= HISTORY_SIZE) history_index = 0;
-    }
+            // draw line, recording the code to erase it
+            PROFILE_ENTER(PZ_DRAW, "draw");
+            dx = abs(line.x2 - line.x1);
+            dy = abs(line.y2 - line.y1);
+            erase.start = NULL;
+            if (erase_start(&erase, (dx > dy ? dx : dy) + 1)) record_erase(&erase);
+            draw_line(line.x1, line.y1, line.x2, line.y2, line.color);
+            record_erase(NULL);
+            PROFILE_EXIT(PZ_DRAW);
+
+            // add to history
+            line_history[head] = line;
+            line_erase[head] = erase;
+            if (erase.start) erase_head = erase.start + speedcode_size(&erase);
+            if (++head == HISTORY_RING) head = 0;
+            ++count;
 
-    // consume key-press
-    cgetc();
+            // remove oldest lines past the history length (two at most, so a
+            // shorter history catches up over a few lines), with their erase
+            // code if they have any
+            PROFILE_ENTER(PZ_ERASE, "erase");
+            for (e = 0; e < 2 && count > governor.history; ++e, --count) {
+                tail = (head >= count) ? head - count : head + HISTORY_RING - count;
+                old = &line_erase[tail];
+                if (old->start && !old->full) {
+                    speedcode_run(old);
+                } else {
+                    draw_line(line_history[tail].x1, line_history[tail].y1,
+                              line_history[tail].x2, line_history[tail].y2,
+                              COLOR_BG);
+                }
+                old->start = NULL;
+            }
+            PROFILE_EXIT(PZ_ERASE);
+
+#ifdef BENCH
+            BENCH_COUNT();
+#endif
+        }
+
+        // move qix heads to the last line's ends (multi-color pixels are 2 wide)
+        PROFILE_ENTER(PZ_SPRITE, "sprite");
+        sprite_set(0, SPRITE_X(line.x1 * 2) - 2, SPRITE_Y(line.y1) - 2,
+                   SPRITE_SHAPE(HEAD_DATA), line.color);
+        sprite_set(1, SPRITE_X(line.x2 * 2) - 2, SPRITE_Y(line.y2) - 2,
+                   SPRITE_SHAPE(HEAD_DATA), line.color);
+        sprite_update();
+        PROFILE_EXIT(PZ_SPRITE);
+        PROFILE_STEP();
+        gov_end();
+
+#ifdef BENCH
+        if (bench_done()) return;
+#endif
+    }
 }
 
 int main(void)
 {
     unsigned char bg_color, border_color;
+    bool turbo;
+
+    // use a REU to clear and a SuperCPU or C128 to run faster, if there is one
+    machine_detect();
+    machine_turbo(true);
+    turbo = machine.c128 && machine.lines > TURBO_ON_LINE;
 
     // setup multi-color bitmap
     setup_bitmap_multi();
@@ -163,12 +299,43 @@ int main(void)
     // clear screen
     clrscr();
 
+#ifdef KERNAL_OFF
+    // bank out BASIC and KERNAL for the main loop
+    kernal_off();
+#endif
+
+    // setup qix head sprites
+    fast_copy(MEMPTR(HEAD_DATA), HEAD_SHAPE, sizeof(HEAD_SHAPE));
+    raster_start();
+    sprite_init();
+    if (turbo) {
+        raster_add(TURBO_ON_LINE, turbo_on);
+        raster_add(TURBO_OFF_LINE, turbo_off);
+    }
+
     // main loop
     draw_lines();
 
+    // remove sprites and turbo
+    if (turbo) {
+        raster_remove(turbo_on);
+        raster_remove(turbo_off);
+        C128_SLOW();
+    }
+    sprite_done();
+    raster_stop();
+
+#ifdef KERNAL_OFF
+    kernal_on();
+#endif
+
     // restore background and border color
     bgcolor(bg_color);
     bordercolor(border_color);
 
+#ifdef BENCH
+    bench_report("qixlinesmc", "lines");
+#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,160 @@
+/**
+ * Sprite Multiplexer
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#include "common.h"
+#include "sprite.h"
+
+// virtual sprites
+static word spr_x[MAX_VSPRITES];
+static byte spr_y[MAX_VSPRITES];
+static byte spr_shape[MAX_VSPRITES];
+static byte spr_color[MAX_VSPRITES];
+
+// virtual sprites sorted by y (kept between frames, as the order rarely changes)
+static byte spr_order[MAX_VSPRITES];
+
+// display lists, one shown by the irq while the other is built
+// entry k uses hardware sprite k & 7, and is set up at raster line dl_line
+static byte dl_count[2];
+static byte dl_x[2][MAX_VSPRITES];
+static byte dl_xhi[2][MAX_VSPRITES];
+static byte dl_y[2][MAX_VSPRITES];
+static byte dl_shape[2][MAX_VSPRITES];
+static byte dl_color[2][MAX_VSPRITES];
+static byte dl_line[2][MAX_VSPRITES];
+static byte dl_front;
+static volatile byte dl_pending;
+
+// next display list entry for the irq (0 at top of frame)
+static byte irq_next;
+
+// sprite pointers at the end of screen memory
+static byte *spr_ptrs;
+
+// raster callback at SPRITE_TOP, and again for each group of reused sprites
+static void sprite_irq(void) {
+    byte f, k, n, hw, bit;
+
+    // top of frame, show the newest display list
+    if (irq_next == 0) {
+        if (dl_pending) {
+            dl_front ^= 1;
+            dl_pending = false;
+        }
+        n = dl_count[dl_front];
+        VIC.spr_ena = (n >= 8) ? 0xff : (1 << n) - 1;
+    }
+
+    f = dl_front;
+    n = dl_count[f];
+    k = irq_next;
+    for (;;) {
+        // set up every entry that is due by now
+        while (k < n && dl_line[f][k] <= VIC.rasterline + 1) {
+            hw = k & 7;
+            bit = 1 << hw;
+            VIC.spr_pos[hw].x = dl_x[f][k];
+            VIC.spr_pos[hw].y = dl_y[f][k];
+            if (dl_xhi[f][k])
+                VIC.spr_hi_x |= bit;
+            else
+                VIC.spr_hi_x &= ~bit;
+            VIC.spr_color[hw] = dl_color[f][k];
+            spr_ptrs[hw] = dl_shape[f][k];
+            ++k;
+        }
+        if (k >= n) break;
+        // passed the next line while setting up? then do it now
+        if (dl_line[f][k] > VIC.rasterline) break;
+    }
+
+    if (k < n) {
+        irq_next = k;
+        raster_again(dl_line[f][k]);
+    } else {
+        irq_next = 0;
+    }
+}
+
+void sprite_init() {
+    byte i;
+
+    spr_ptrs = (byte *)get_screen_memory() + 0x3f8;
+    for (i = 0; i < MAX_VSPRITES; ++i) {
+        spr_y[i] = SPRITE_HIDDEN;
+        spr_order[i] = i;
+    }
+    dl_count[0] = dl_count[1] = 0;
+    dl_front = 0;
+    dl_pending = false;
+    irq_next = 0;
+    raster_add(SPRITE_TOP, sprite_irq);
+}
+
+void sprite_done() {
+    raster_remove(sprite_irq);
+    VIC.spr_ena = 0;
+}
+
+void sprite_set(byte i, word x, byte y, byte shape, byte color) {
+    spr_x[i] = x;
+    spr_y[i] = y;
+    spr_shape[i] = shape;
+    spr_color[i] = color;
+}
+
+void sprite_move(byte i, word x, byte y) {
+    spr_x[i] = x;
+    spr_y[i] = y;
+}
+
+void sprite_hide(byte i) {
+    spr_y[i] = SPRITE_HIDDEN;
+}
+
+void sprite_update() {
+    byte i, j, a, b, n, y;
+    int line;
+
+    // keep the irq from taking the back list until it is complete
+    dl_pending = false;
+    b = dl_front ^ 1;
+
+    // sort by y
+    for (i = 1; i < MAX_VSPRITES; ++i) {
+        a = spr_order[i];
+        y = spr_y[a];
+        for (j = i; j > 0 && spr_y[spr_order[j - 1]] > y; --j)
+            spr_order[j] = spr_order[j - 1];
+        spr_order[j] = a;
+    }
+
+    // build display list
+    n = 0;
+    for (i = 0; i < MAX_VSPRITES; ++i) {
+        a = spr_order[i];
+        y = spr_y[a];
+        if (y == SPRITE_HIDDEN) continue;
+        if (n < 8) {
+            line = SPRITE_TOP;
+        } else {
+            // reuse the hardware sprite once its last use has been drawn
+            line = dl_y[b][n - 8] + SPRITE_HEIGHT;
+            // not free in time, more than 8 sprites on these lines
+            if (line + SPRITE_GAP > y) continue;
+        }
+        dl_x[b][n] = spr_x[a] & 0xff;
+        dl_xhi[b][n] = spr_x[a] >> 8;
+        dl_y[b][n] = y;
+        dl_shape[b][n] = spr_shape[a];
+        dl_color[b][n] = spr_color[a];
+        dl_line[b][n] = line;
+        ++n;
+    }
+    dl_count[b] = n;
+    dl_pending = true;
+}
@@ -0,0 +1,51 @@
+/**
+ * Sprite Multiplexer
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#ifndef _SPRITE_H
+#define _SPRITE_H
+
+#include "common.h"
+
+// number of virtual sprites
+#ifndef MAX_VSPRITES
+#define MAX_VSPRITES 16
+#endif
+
+#define SPRITE_HEIGHT  21               // sprite height in raster lines
+#define SPRITE_GAP     4                // spare lines for the raster irq to reuse a sprite
+#define SPRITE_HIDDEN  0                // y position of a hidden sprite
+#define SPRITE_TOP     16               // raster line of the top of frame callback
+
+// convert screen coordinates to sprite coordinates
+#define SPRITE_X(x) ((x) + 24)
+#define SPRITE_Y(y) ((y) + 50)
+
+// sprite pointer value for sprite data at addr (must be in the current VIC bank)
+#define SPRITE_SHAPE(addr) ((byte)(((addr) & 0x3fff) >> 6))
+
+///// FUNCTIONS /////
+
+// add raster irq callback and hide all virtual sprites
+// (the raster scheduler must be started with raster_start)
+void sprite_init();
+
+// remove raster irq callback and turn off hardware sprites
+void sprite_done();
+
+// set virtual sprite position, shape and color (y of SPRITE_HIDDEN hides it)
+void sprite_set(byte i, word x, byte y, byte shape, byte color);
+
+// move virtual sprite
+void sprite_move(byte i, word x, byte y);
+
+// hide virtual sprite
+void sprite_hide(byte i);
+
+// sort virtual sprites and hand them to the raster irq for the next frame
+void sprite_update();
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * Frame Governor
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#include <c64.h>
+#include <cbm.h>
+#include <conio.h>
+
+#include "governor.h"
+#include "machine.h"
+
+// CIA1 timer B control: start, one-shot (it stops at 0), force load
+#define TIMER_START    0x19
+#define TIMER_ONE_SHOT 0x08
+
+governor_s governor;
+
+// history per line drawn per frame
+static unsigned char history_per_line;
+
+static void set_history(void)
+{
+    unsigned short h = governor.lines * history_per_line;
+
+    governor.history = (h < GOV_MAX_HISTORY) ? h : GOV_MAX_HISTORY;
+}
+
+void gov_init(unsigned char history)
+{
+    governor.budget = machine.lines * ((machine.tv == TV_NTSC) ? 65 : 63);
+    governor.target = governor.budget - (governor.budget >> 3);
+    governor.used = 0;
+    governor.headroom = governor.target;
+    governor.line_cost = 0;
+    governor.lines = 1;
+    history_per_line = history;
+    set_history();
+}
+
+#ifdef BENCH
+
+// benchmarks draw flat out, at the one line a pass gov_init set
+void gov_start(void)
+{
+}
+
+void gov_end(void)
+{
+}
+
+#else
+
+void gov_start(void)
+{
+    waitvsync();
+    // count down from 0xffff, enough for over three frames
+    CIA1.crb = TIMER_ONE_SHOT;
+    CIA1.tb_lo = 0xff;
+    CIA1.tb_hi = 0xff;
+    CIA1.crb = TIMER_START;
+}
+
+void gov_end(void)
+{
+    unsigned short used, cost;
+
+    // still running? (in one-shot mode it stops when it runs out)
+    if (CIA1.crb & 1) {
+        CIA1.crb = TIMER_ONE_SHOT;
+        used = ~(CIA1.tb_lo | (CIA1.tb_hi << 8));
+    } else {
+        used = 0xffff;
+    }
+    governor.used = used;
+    governor.headroom = (used < 0x8000) ? (int)(governor.target - used) : -0x7fff;
+
+    // average cost of a line, over about the last four frames
+    cost = used / governor.lines;
+    if (cost > 0x7fff) cost = 0x7fff;
+    governor.line_cost += ((int)cost - (int)governor.line_cost) >> 2;
+
+    // one line fewer if the frame ran over, one more if another would fit
+    if (used > governor.target) {
+        if (governor.lines > 1) --governor.lines;
+    } else if (governor.lines < GOV_MAX_LINES &&
+               (unsigned long)used + governor.line_cost < governor.target) {
+        ++governor.lines;
+    }
+    set_history();
+}
+
+#endif
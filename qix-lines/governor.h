@@ -0,0 +1,56 @@
+/**
+ * Frame Governor
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * Times the work done each frame with CIA1 timer B, against the length of a
+ * frame (312 lines of 63 cycles on PAL, 263 of 65 on NTSC), and picks how
+ * many lines to draw in the next one so the animation keeps to one step per
+ * frame: fewer when the last frame ran over, more while another line's
+ * worth of time is left. The history (lines kept on screen) follows, so a
+ * line stays up for the same number of frames whatever the rate.
+ *
+ * BENCH builds leave it out: one line a pass and a fixed history, with no
+ * wait for the frame, so the benchmark counts how fast lines are drawn.
+ */
+
+#ifndef _GOVERNOR_H
+#define _GOVERNOR_H
+
+// most lines drawn per frame
+#ifndef GOV_MAX_LINES
+#define GOV_MAX_LINES 4
+#endif
+
+// most lines kept on screen (the size of a history ring)
+#ifndef GOV_MAX_HISTORY
+#define GOV_MAX_HISTORY 32
+#endif
+
+// settings and measurements
+typedef struct {
+    unsigned short budget;              // cycles per frame
+    unsigned short target;              // cycles of work aimed for (7/8 of budget)
+    unsigned short used;                // cycles the last frame's work took
+    int headroom;                       // target - used, negative if over
+    unsigned short line_cost;           // average cycles per line
+    unsigned char lines;                // lines to draw this frame
+    unsigned char history;              // lines to keep on screen
+} governor_s;
+
+extern governor_s governor;
+
+///// FUNCTIONS /////
+
+// start at one line per frame, keeping history lines on screen for each
+// line drawn per frame (needs machine_detect first)
+void gov_init(unsigned char history);
+
+// wait for the next frame and start timing it
+void gov_start(void);
+
+// stop timing the frame and pick the lines and history for the next one
+void gov_end(void);
+
+#endif
@@ -14,16 +14,31 @@
 #include <stdlib.h>
 #include <tgi.h>
 
+#include "governor.h"
+#include "machine.h"
+#include "rng.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
+
+// tgi driver file, for TGI_MODULE builds
+#ifndef TGI_DRIVER
+#define TGI_DRIVER "c64-hi.tgi"
+#endif
+
 #define MAX_COLORS   16
 #define COLOR_BG     TGI_COLOR_BLACK
 #define COLOR_FG     TGI_COLOR_WHITE
 #define MAX_SIN      180
-#define HISTORY_SIZE 10                 // how many lines to display at once
+#define HISTORY_SIZE 10                 // lines on screen per line drawn a frame
+#define HISTORY_RING (GOV_MAX_HISTORY + 1)  // history, and the line just drawn
 #define STEP         8                  // line spacing
 #define STEP_RANGE   6                  // spacing plus/minus range
+#define BITMAP       0xe000             // where the hires tgi drivers keep the bitmap
 
 // use all colors except black (0)
-#define RANDOM_COLOR() (rand() % (MAX_COLORS - 1) + 1)
+#define RANDOM_COLOR() (RNG_RANGE8(MAX_COLORS - 1) + 1)
 
 typedef unsigned char byte;
 typedef unsigned short ushort;
@@ -52,7 +67,7 @@ void set_color(const byte color)
 ushort next_degree(const ushort degree)
 {
     // add randomly to the degree
-    ushort d = degree + STEP + (int)rand() % (STEP_RANGE * 2 + 1) - STEP_RANGE;
+    ushort d = degree + STEP + RNG_RANGE8(STEP_RANGE * 2 + 1) - STEP_RANGE;
     if (d >= MAX_SIN) d = d - MAX_SIN;
     return d;
 }
@@ -117,46 +132,68 @@ void next_line(line_s *line, line_s *line_delta, line_s *line_degree)
 // draw lines until a key is pressed
 void draw_lines()
 {
-    line_s line, line_delta, line_degree, line_history[HISTORY_SIZE];
-    ushort history_index;
+    line_s line, line_delta, line_degree, line_history[HISTORY_RING];
+    byte head, count, tail, n, e;
 
     // set random color
     tgi_setcolor(RANDOM_COLOR());
 
     // randomize starting values
-    line.x1 = rand() % x_size;
-    line.y1 = rand() % y_size;
-    line.x2 = rand() % x_size;
-    line.y2 = rand() % y_size;
+    line.x1 = RNG_RANGE(x_size);
+    line.y1 = RNG_RANGE(y_size);
+    line.x2 = RNG_RANGE(x_size);
+    line.y2 = RNG_RANGE(y_size);
 
     line_delta.x1 = STEP;
     line_delta.y1 = STEP;
     line_delta.x2 = STEP;
     line_delta.y2 = STEP;
 
-    line_degree.x1 = rand() % MAX_SIN;
-    line_degree.y1 = rand() % MAX_SIN;
-    line_degree.x2 = rand() % MAX_SIN;
-    line_degree.y2 = rand() % MAX_SIN;
-    history_index = 0;
-
-    // loop until key-press
-    while (!kbhit()) {
-        // get next line
-        next_line(&line, &line_delta, &line_degree);
-
-        // draw line
-        tgi_setcolor(COLOR_FG);
-        tgi_line(line.x1, line.y1, line.x2, line.y2);
+    line_degree.x1 = RNG_RANGE8(MAX_SIN);
+    line_degree.y1 = RNG_RANGE8(MAX_SIN);
+    line_degree.x2 = RNG_RANGE8(MAX_SIN);
+    line_degree.y2 = RNG_RANGE8(MAX_SIN);
+    head = count = 0;
+    gov_init(HISTORY_SIZE);
 
-        // undraw oldest line
-        tgi_setcolor(COLOR_BG);
-        tgi_line(line_history[history_index].x1, line_history[history_index].y1,
-                 line_history[history_index].x2, line_history[history_index].y2);
+#ifdef BENCH
+    bench_start();
+#endif
 
-        // add to history
-        line_history[history_index++] = line;
-        if (history_index >= HISTORY_SIZE) history_index = 0;
+    // loop until key-press, a frame at a time
+    while (!kbhit()) {
+        gov_start();
+        for (n = 0; n < governor.lines; ++n) {
+            // get next line
+            next_line(&line, &line_delta, &line_degree);
+
+            // draw line
+            tgi_setcolor(COLOR_FG);
+            tgi_line(line.x1, line.y1, line.x2, line.y2);
+
+            // add to history
+            line_history[head] = line;
+            if (++head == HISTORY_RING) head = 0;
+            ++count;
+
+            // undraw oldest lines past the history length (two at most, so a
+            // shorter history catches up over a few lines)
+            tgi_setcolor(COLOR_BG);
+            for (e = 0; e < 2 && count > governor.history; ++e, --count) {
+                tail = (head >= count) ? head - count : head + HISTORY_RING - count;
+                tgi_line(line_history[tail].x1, line_history[tail].y1,
+                         line_history[tail].x2, line_history[tail].y2);
+            }
+
+#ifdef BENCH
+            BENCH_COUNT();
+#endif
+        }
+        gov_end();
+
+#ifdef BENCH
+        if (bench_done()) return;
+#endif
     }
 
     // consume key-press
@@ -167,10 +204,27 @@ int main(void)
 {
     byte border_color;
 
+    // run at SuperCPU speed, if there is one
+    machine_detect();
+    machine_turbo(1);
+
     // setup tgi
+#ifdef TGI_MODULE
+    // load driver from disk, instead of linking it in
+    tgi_load_driver(TGI_DRIVER);
+    if (tgi_geterror() != TGI_ERR_OK) {
+        cputs("cannot load " TGI_DRIVER "\r\n");
+        return EXIT_FAILURE;
+    }
+#else
     tgi_install(tgi_static_stddrv);
+#endif
     tgi_init();
-    tgi_clear();
+    // the REU clears a byte a cycle, several times faster than the driver
+    if (machine.reu_banks)
+        fast_clear(MEMPTR(BITMAP), 8000);
+    else
+        tgi_clear();
 
     // set globals
     x_size = tgi_getxres();
@@ -186,8 +240,16 @@ int main(void)
     bordercolor(border_color);
 
     // cleanup tgi
+#ifdef TGI_MODULE
+    tgi_unload();
+#else
     tgi_uninstall();
+#endif
     clrscr();
 
+#ifdef BENCH
+    bench_report("qixlines", "lines");
+#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,52 @@
+/**
+ * Random Numbers
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ */
+
+#include <c64.h>
+#include <peekpoke.h>
+
+#include "rng.h"
+
+unsigned char rng_lo = 1, rng_hi = 0;
+
+void rng_seed(unsigned short seed)
+{
+    if (!seed) seed = 1;
+    rng_lo = seed;
+    rng_hi = seed >> 8;
+}
+
+void rng_sid_start(void)
+{
+    SID.v3.freq = 0xffff;
+    SID.v3.ctrl = 0x80;
+}
+
+void rng_seed_sid(void)
+{
+    rng_sid_start();
+    rng_seed((((unsigned short)CIA1.ta_hi << 8) | VIC.rasterline) ^ RNG_SID());
+}
+
+unsigned char __fastcall__ rng_below8(unsigned char mask, unsigned char n)
+{
+    unsigned char r;
+
+    do {
+        r = RNG_BYTE() & mask;
+    } while (r >= n);
+    return r;
+}
+
+unsigned short __fastcall__ rng_below(unsigned short mask, unsigned short n)
+{
+    unsigned short r;
+
+    do {
+        r = RNG_WORD() & mask;
+    } while (r >= n);
+    return r;
+}
@@ -0,0 +1,68 @@
+/**
+ * Random Numbers
+ *
+ * Copyright © 2023-2025 Kyle W T Sherman
+ * MIT License
+ *
+ * A 16-bit xorshift (7, 9, 8) done a byte at a time, so it can be inlined
+ * with no shifts or calls, and numbers in a range by masking and trying
+ * again instead of with % (no division). The SID's voice 3 noise is there
+ * to seed it, or as a source of its own.
+ */
+
+#ifndef _RNG_H
+#define _RNG_H
+
+#include <peekpoke.h>
+
+#define SID_OSC3 0xd41b                 // voice 3 oscillator output
+
+// state (never 0), low and high bytes
+extern unsigned char rng_lo, rng_hi;
+
+///// MACROS /////
+
+// step the xorshift and return its low byte (period 65535)
+// (x ^= x << 7; x ^= x >> 9; x ^= x << 8)
+#define RNG_BYTE() \
+    (rng_hi ^= (unsigned char)((rng_hi << 7) | (rng_lo >> 1)), \
+     rng_lo ^= (unsigned char)(rng_lo << 7), \
+     rng_lo ^= rng_hi >> 1, \
+     rng_hi ^= rng_lo, \
+     rng_lo)
+
+// step the xorshift and return all 16 bits
+#define RNG_WORD() ((void)RNG_BYTE(), (rng_hi << 8) | rng_lo)
+
+// smallest 2^n - 1 that is >= v (v up to 16 bits, constant for constant v)
+#define RNG_SMEAR(v) ((v) | (v) >> 1 | (v) >> 2 | (v) >> 3 | (v) >> 4 | (v) >> 5 | \
+                      (v) >> 6 | (v) >> 7 | (v) >> 8 | (v) >> 9 | (v) >> 10 | \
+                      (v) >> 11 | (v) >> 12 | (v) >> 13 | (v) >> 14 | (v) >> 15)
+
+// random number from 0 to n - 1 (n from 1 to 255, or to 65535 for RNG_RANGE)
+#define RNG_RANGE8(n) rng_below8(RNG_SMEAR((n) - 1), (n))
+#define RNG_RANGE(n) rng_below(RNG_SMEAR((n) - 1), (n))
+
+// SID noise, after rng_sid_start (a new value every few cycles, so reads
+// close together are related)
+#define RNG_SID() PEEK(SID_OSC3)
+
+///// FUNCTIONS /////
+
+// set the state (0 is taken as 1)
+void rng_seed(unsigned short seed);
+
+// start voice 3 on noise at its highest frequency (silent, it is not gated
+// or routed to the output)
+void rng_sid_start(void);
+
+// seed from the SID noise, the raster line and CIA1 timer A, which differ
+// from run to run (calls rng_sid_start)
+void rng_seed_sid(void);
+
+// random number from 0 to n - 1, given mask = RNG_SMEAR(n - 1), by trying
+// until one is in range (under two tries on average)
+unsigned char __fastcall__ rng_below8(unsigned char mask, unsigned char n);
+unsigned short __fastcall__ rng_below(unsigned short mask, unsigned short n);
+
+#endif
@@ -9,22 +9,201 @@
 #include <modload.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <tgi.h>
 
+#include "rng.h"
+
+#ifdef BENCH
+#include "bench.h"
+#endif
+
+// tgi driver file, for TGI_MODULE builds
+#ifndef TGI_DRIVER
+#define TGI_DRIVER "c64-hi.tgi"
+#endif
+
+#define MAX_RESULTS    16
+#define MEMSET_SIZE    0x2000
+#define BADLINES       25               // one per character row
+#define BADLINE_CYCLES 40               // cycles the VIC takes on each badline
+
+typedef unsigned char byte;
+typedef unsigned short ushort;
+typedef unsigned long ulong;
+
+// measure stmt run runs times, and add its cycles per run to the results
+#define MEASURE(name, runs, stmt)               \
+    timer_start();                              \
+    for (i = 0; i < (runs); ++i) {              \
+        stmt;                                   \
+    }                                           \
+    add_result(name, timer_stop(), runs)
+
+// results
+static const char *result_name[MAX_RESULTS];
+static ulong result_cycles[MAX_RESULTS];
+static byte result_count;
+
+// cycles of an empty MEASURE, and per run of its loop
+static ulong timer_overhead;
+static ulong loop_overhead;
+
+// operands and results, in globals so the compiler can not fold them away
+static ushort a16 = 1234, b16 = 56, r16;
+static ushort angle = 154;              // degrees, in range for _sin
+static ulong a32 = 123456, b32 = 789, r32;
+
+// start CIA2 timers A and B as a 32-bit cycle counter (interrupts off)
+static void timer_start(void)
+{
+    asm("sei");
+    CIA2.cra = 0;
+    CIA2.crb = 0;
+    CIA2.ta_lo = 0xff;
+    CIA2.ta_hi = 0xff;
+    CIA2.tb_lo = 0xff;
+    CIA2.tb_hi = 0xff;
+    // timer B counts timer A underflows, timer A counts cycles
+    CIA2.crb = 0x51;
+    CIA2.cra = 0x11;
+}
+
+// stop timers and return cycles since timer_start (interrupts on)
+static ulong timer_stop(void)
+{
+    ushort a, b;
+
+    CIA2.cra = 0;
+    CIA2.crb = 0;
+    asm("cli");
+    a = CIA2.ta_lo | (CIA2.ta_hi << 8);
+    b = CIA2.tb_lo | (CIA2.tb_hi << 8);
+    return ~(((ulong)b << 16) | a);
+}
+
+static void add_result(const char *name, ulong cycles, ushort runs)
+{
+    if (result_count >= MAX_RESULTS) return;
+    cycles -= timer_overhead + loop_overhead * runs;
+    result_name[result_count] = name;
+    result_cycles[result_count] = (cycles > 0x7fffffffUL) ? 0 : cycles / runs;
+    ++result_count;
+}
+
+// measure the timer and an empty loop, to take out of every result
+static void calibrate(void)
+{
+    ushort i;
+
+    timer_overhead = 0;
+    loop_overhead = 0;
+    timer_start();
+    timer_overhead = timer_stop();
+    timer_start();
+    for (i = 0; i < 1000; ++i) ;
+    loop_overhead = (timer_stop() - timer_overhead) / 1000;
+}
+
+// cycles from the top of one frame to the next
+static ulong frame_cycles(void)
+{
+    ulong cycles;
+
+    while (VIC.rasterline != 0 || (VIC.ctrl1 & 0x80)) ;
+    timer_start();
+    while (VIC.rasterline == 0) ;
+    while (VIC.rasterline != 0 || (VIC.ctrl1 & 0x80)) ;
+    cycles = timer_stop();
+    return cycles - timer_overhead;
+}
+
 int main(void)
 {
+    ushort i, x_res, y_res;
+    ulong frame, measured;
+    byte tv, colors, *buf;
+
+#ifdef BENCH
+    bench_start();
+#endif
+
+    calibrate();
+
+    // video standard and frame length
+    tv = get_tv();
+    frame = (tv == TV_NTSC) ? 65UL * 263 : 63UL * 312;
+    measured = frame_cycles();
+
+    // console (text mode)
+    MEASURE("printf", 10, printf("printf %u\n", i));
+
+    // arithmetic
+    MEASURE("mul 16", 100, r16 = a16 * b16);
+    MEASURE("div 16", 100, r16 = a16 / b16);
+    MEASURE("mul 32", 100, r32 = a32 * b32);
+    MEASURE("div 32", 100, r32 = a32 / b32);
+    MEASURE("_sin", 100, r16 = _sin(angle));
+    MEASURE("rand", 100, r16 = rand());
+    MEASURE("rand % 13", 100, r16 = rand() % 13);
+    MEASURE("RNG_WORD", 100, r16 = RNG_WORD());
+    MEASURE("RNG_RANGE8 13", 100, r16 = RNG_RANGE8(13));
+
+    // memory
+    if ((buf = malloc(MEMSET_SIZE)) != NULL) {
+        MEASURE("memset 8k", 4, memset(buf, i, MEMSET_SIZE));
+        free(buf);
+    }
+
     // setup tgi
+#ifdef TGI_MODULE
+    // load driver from disk, instead of linking it in
+    tgi_load_driver(TGI_DRIVER);
+    if (tgi_geterror() != TGI_ERR_OK) {
+        printf("cannot load %s\n", TGI_DRIVER);
+        return EXIT_FAILURE;
+    }
+#else
     tgi_install(tgi_static_stddrv);
+#endif
     tgi_init();
+    x_res = tgi_getxres();
+    y_res = tgi_getyres();
+    colors = tgi_getcolorcount();
+
+    // graphics
+    MEASURE("tgi_clear", 4, tgi_clear());
+    MEASURE("tgi_setpixel", 100, tgi_setpixel(i, i));
+    MEASURE("tgi_getpixel", 100, r16 = tgi_getpixel(i, i));
+    MEASURE("tgi_line", 10, tgi_line(0, 0, 319, 199));
+
+    // cleanup tgi
+#ifdef TGI_MODULE
+    tgi_unload();
+#else
+    tgi_uninstall();
+#endif
+    clrscr();
 
     // output system info
     printf("char, int, long sizes: %d, %d, %d\n",
            sizeof((char) 0), sizeof((int) 0), sizeof((long) 0));
-    printf("x res: %d, y res: %d, colors: %d\n",
-           tgi_getxres(), tgi_getyres(), tgi_getcolorcount());
+    printf("x res: %d, y res: %d, colors: %d\n", x_res, y_res, colors);
+    printf("video: %s, frame: %lu cycles (%lu measured)\n",
+           (tv == TV_NTSC) ? "ntsc" : (tv == TV_PAL) ? "pal" : "other",
+           frame, measured);
+    printf("cpu cycles per frame after badlines: %lu\n",
+           frame - BADLINES * BADLINE_CYCLES);
+    printf("\n%-14s %8s %9s\n", "test", "cycles", "per frame");
+    for (i = 0; i < result_count; ++i)
+        printf("%-14s %8lu %9lu\n", result_name[i], result_cycles[i],
+               result_cycles[i]
+               ? (frame - BADLINES * BADLINE_CYCLES) / result_cycles[i] : 0);
 
-    // cleanup tgi
-    tgi_uninstall();
+#ifdef BENCH
+    BENCH_COUNT();
+    bench_report("systeminfo", "runs");
+#endif
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,625 @@
+;
+; Fast 320x200 hires TGI driver (a drop-in for the cc65 c64-hi driver)
+;
+; Same memory layout and interface as c64-hi: bitmap at $E000 (under the
+; KERNAL), colors at $D000 (under I/O), VIC bank 3. Pixel addresses come
+; from a table of row addresses, lines have one loop per octant (x always
+; increases, so four) and shallow lines write a whole byte at a time, bars
+; fill whole bytes, and clear is unrolled.
+;
+; It exports tgi_static_stddrv, so the linker takes it instead of the cc65
+; library's c64-hi driver. Builds that load the driver from disk define
+; TGI_MODULE (cl65 --asm-define TGI_MODULE) to leave it out.
+;
+
+.ifndef TGI_MODULE
+
+        .include        "zeropage.inc"
+        .include        "tgi-kernel.inc"
+        .include        "tgi-error.inc"
+
+        .export         _tgi_static_stddrv
+
+; Memory
+
+VBASE   = $E000                 ; bitmap
+CBASE   = $D000                 ; colors
+XRES    = 320
+YRES    = 200
+
+; Arguments (from the TGI kernel)
+
+X1      = ptr1
+Y1      = ptr2
+X2      = ptr3
+Y2      = ptr4
+
+; Zero page (scratch between calls)
+
+POINT   = regsave               ; address of the current cell row
+PIXEL   = tmp1                  ; bit of the current pixel
+MASK    = tmp2                  ; bits to write to the current byte
+DY      = tmp3                  ; line: |y2 - y1|
+COUNT   = tmp4                  ; line: pixels left, high byte
+DX      = sreg                  ; line: x2 - x1
+ERR     = ptr3                  ; line: error term (after x2 is used)
+
+; Header
+
+.rodata
+
+_tgi_static_stddrv:
+        .byte   $74, $67, $69   ; "tgi"
+        .byte   TGI_API_VERSION ; TGI API version number
+        .addr   $0000           ; library reference
+        .word   XRES            ; x resolution
+        .word   YRES            ; y resolution
+        .byte   2               ; number of drawing colors
+        .byte   1               ; number of screens available
+        .byte   8               ; system font x size
+        .byte   8               ; system font y size
+        .word   $00D4           ; aspect ratio (based on 4/3 display)
+        .byte   0               ; TGI driver flags
+
+; Jump table
+
+        .addr   INSTALL
+        .addr   UNINSTALL
+        .addr   INIT
+        .addr   DONE
+        .addr   GETERROR
+        .addr   CONTROL
+        .addr   CLEAR
+        .addr   SETVIEWPAGE
+        .addr   SETDRAWPAGE
+        .addr   SETCOLOR
+        .addr   SETPALETTE
+        .addr   GETPALETTE
+        .addr   GETDEFPALETTE
+        .addr   SETPIXEL
+        .addr   GETPIXEL
+        .addr   LINE
+        .addr   BAR
+        .addr   TEXTSTYLE
+        .addr   OUTTEXT
+
+; Tables
+
+; address of the top of each cell row, by y
+ROWLO:
+        .repeat YRES, I
+        .byte   <(VBASE + (I / 8) * XRES)
+        .endrep
+ROWHI:
+        .repeat YRES, I
+        .byte   >(VBASE + (I / 8) * XRES)
+        .endrep
+
+; pixel bit, by x & 7
+BITTAB: .byte   $80, $40, $20, $10, $08, $04, $02, $01
+
+; pixels from x & 7 to the right of the byte, and from the left to x & 7
+LEFTMASK:
+        .byte   $FF, $7F, $3F, $1F, $0F, $07, $03, $01
+RIGHTMASK:
+        .byte   $80, $C0, $E0, $F0, $F8, $FC, $FE, $FF
+
+DEFPALETTE:
+        .byte   $00, $01        ; white on black
+
+; Variables
+
+.bss
+
+ERROR:          .res    1       ; error code
+BITMASK:        .res    1       ; $00 or $FF, by color
+PALETTE:        .res    2       ; background and foreground color
+
+; Macros
+
+; set the MASK bits of the byte at (POINT),y to the drawing color
+.macro  flush
+        lda     (POINT),y
+        eor     BITMASK
+        and     MASK
+        eor     (POINT),y
+        sta     (POINT),y
+.endmacro
+
+; move POINT and y to the next pixel row, up or down
+.macro  nextrow up
+    .if up
+        dey
+        bpl     :+
+        ldy     #$07
+        lda     POINT
+        sec
+        sbc     #<XRES
+        sta     POINT
+        lda     POINT+1
+        sbc     #>XRES
+        sta     POINT+1
+:
+    .else
+        iny
+        cpy     #$08
+        bne     :+
+        ldy     #$00
+        lda     POINT
+        clc
+        adc     #<XRES
+        sta     POINT
+        lda     POINT+1
+        adc     #>XRES
+        sta     POINT+1
+:
+    .endif
+.endmacro
+
+; line with dx >= dy: a pixel per x, gathered in MASK until the line leaves
+; the byte (x is the low byte of the pixels left, COUNT the high byte)
+.macro  shallow up
+        .local  pixel, step, error, ystep, move, done
+pixel:  lda     MASK
+        ora     PIXEL
+        sta     MASK
+        txa
+        bne     step
+        lda     COUNT
+        beq     done
+        dec     COUNT
+step:   dex
+        lsr     PIXEL
+        bcc     error
+        ror     PIXEL           ; next byte, pixel bit 7 and carry clear
+        flush
+        lda     #$00
+        sta     MASK
+        lda     POINT
+        adc     #$08
+        sta     POINT
+        bcc     error
+        inc     POINT+1
+error:  lda     ERR
+        sec
+        sbc     DY
+        sta     ERR
+        bcs     pixel
+        lda     ERR+1
+        beq     ystep
+        dec     ERR+1
+        jmp     pixel
+ystep:  lda     ERR             ; error += dx (it went below zero)
+        clc
+        adc     DX
+        sta     ERR
+        lda     DX+1
+        adc     #$FF
+        sta     ERR+1
+        lda     MASK
+        beq     move
+        flush
+        lda     #$00
+        sta     MASK
+move:   nextrow up
+        jmp     pixel
+done:   flush
+        jmp     LINEDONE
+.endmacro
+
+; line with dy > dx: a pixel per y (x is the pixels left)
+.macro  steep up
+        .local  pixel, error, done
+pixel:  lda     (POINT),y
+        eor     BITMASK
+        and     PIXEL
+        eor     (POINT),y
+        sta     (POINT),y
+        dex
+        beq     done
+        nextrow up
+        lda     ERR
+        sec
+        sbc     DX
+        sta     ERR
+        bcs     pixel
+        adc     DY              ; carry clear
+        sta     ERR
+        lsr     PIXEL
+        bcc     pixel
+        ror     PIXEL           ; next byte, pixel bit 7 and carry clear
+        lda     POINT
+        adc     #$08
+        sta     POINT
+        bcc     pixel
+        inc     POINT+1
+        jmp     pixel
+done:   jmp     LINEDONE
+.endmacro
+
+.code
+
+; INSTALL, UNINSTALL: nothing to do
+
+INSTALL:
+UNINSTALL:
+        rts
+
+; INIT: switch to graphics mode (bank 3, colors at $D000, bitmap at $E000)
+
+INIT:
+        lda     #$FF
+        sta     BITMASK
+        lda     $DD02
+        ora     #$03
+        sta     $DD02
+        lda     $DD00
+        and     #$FC
+        sta     $DD00
+        lda     $D011
+        ora     #$20
+        sta     $D011
+        lda     #$48
+        sta     $D018
+        lda     #TGI_ERR_OK
+        sta     ERROR
+        rts
+
+; DONE: back to text mode (bank 0, screen at $0400)
+
+DONE:
+        lda     $DD02
+        ora     #$03
+        sta     $DD02
+        lda     $DD00
+        ora     #$03
+        sta     $DD00
+        lda     $D011
+        and     #<~$20
+        sta     $D011
+        lda     #$15
+        sta     $D018
+        rts
+
+; GETERROR: return the error code in A and clear it
+
+GETERROR:
+        ldx     #TGI_ERR_OK
+        lda     ERROR
+        stx     ERROR
+        rts
+
+; CONTROL: no special functions
+
+CONTROL:
+        lda     #TGI_ERR_INV_FUNC
+        sta     ERROR
+        rts
+
+; CLEAR: clear the bitmap, 31 pages at a time and then the last 64 bytes
+
+CLEAR:
+        lda     #$00
+        tay
+@page:
+        .repeat $1F, I
+        sta     VBASE + I * $100,y
+        .endrep
+        iny
+        bne     @page
+        ldy     #$3F
+@rest:  sta     VBASE + $1F00,y
+        dey
+        bpl     @rest
+        rts
+
+; SETVIEWPAGE, SETDRAWPAGE: one page only (the kernel checks A)
+
+SETVIEWPAGE:
+SETDRAWPAGE:
+        rts
+
+; SETCOLOR: set the drawing color in A (0 or 1)
+
+SETCOLOR:
+        tax
+        beq     @set
+        lda     #$FF
+@set:   sta     BITMASK
+        rts
+
+; SETPALETTE: set the palette from ptr1 and fill the colors with it
+
+SETPALETTE:
+        ldy     #$01
+@copy:  lda     (ptr1),y
+        and     #$0F
+        sta     PALETTE,y
+        dey
+        bpl     @copy
+        lda     PALETTE+1       ; foreground in the high nybble
+        asl     a
+        asl     a
+        asl     a
+        asl     a
+        ora     PALETTE
+        tax
+        ldy     #$00
+        php
+        sei
+        lda     $01             ; colors are under I/O
+        pha
+        lda     #$34
+        sta     $01
+        txa
+@fill:  sta     CBASE + $0000,y
+        sta     CBASE + $0100,y
+        sta     CBASE + $0200,y
+        sta     CBASE + $02E8,y
+        iny
+        bne     @fill
+        pla
+        sta     $01
+        plp
+        lda     #TGI_ERR_OK
+        sta     ERROR
+        rts
+
+; GETPALETTE, GETDEFPALETTE: return a pointer to the palette in A/X
+
+GETPALETTE:
+        lda     #<PALETTE
+        ldx     #>PALETTE
+        rts
+
+GETDEFPALETTE:
+        lda     #<DEFPALETTE
+        ldx     #>DEFPALETTE
+        rts
+
+; SETPIXEL: set the pixel at X1/Y1 (in range) to the drawing color
+
+SETPIXEL:
+        jsr     CALC
+        php
+        sei
+        lda     $01             ; bitmap is under the KERNAL
+        pha
+        lda     #$35
+        sta     $01
+        lda     (POINT),y
+        eor     BITMASK
+        and     BITTAB,x
+        eor     (POINT),y
+        sta     (POINT),y
+        pla
+        sta     $01
+        plp
+        rts
+
+; GETPIXEL: return the color of the pixel at X1/Y1 (in range) in A/X
+
+GETPIXEL:
+        jsr     CALC
+        php
+        sei
+        lda     $01
+        pha
+        lda     #$35
+        sta     $01
+        lda     (POINT),y
+        and     BITTAB,x
+        tax
+        pla
+        sta     $01
+        plp
+        txa
+        beq     @done
+        lda     #$01
+@done:  ldx     #$00
+        rts
+
+; LINE: draw a line from X1/Y1 to X2/Y2 (in range)
+
+LINE:
+        lda     X2              ; draw left to right
+        cmp     X1
+        lda     X2+1
+        sbc     X1+1
+        bcs     @sorted
+        ldx     X1
+        lda     X2
+        stx     X2
+        sta     X1
+        ldx     X1+1
+        lda     X2+1
+        stx     X2+1
+        sta     X1+1
+        ldx     Y1
+        lda     Y2
+        stx     Y2
+        sta     Y1
+@sorted:
+        lda     X2
+        sec
+        sbc     X1
+        sta     DX
+        lda     X2+1
+        sbc     X1+1
+        sta     DX+1
+        jsr     CALC
+        lda     BITTAB,x
+        sta     PIXEL
+        lda     #$00
+        sta     MASK
+        php
+        sei
+        lda     $01
+        pha
+        lda     #$35
+        sta     $01
+        lda     Y2              ; dy and octant
+        sec
+        sbc     Y1
+        bcs     @down
+        eor     #$FF
+        adc     #$01
+        sta     DY
+        jsr     OCTANT
+        bcs     @steepup
+        jmp     SHALLOWUP
+@steepup:
+        jmp     STEEPUP
+@down:  sta     DY
+        jsr     OCTANT
+        bcs     @steepdown
+        jmp     SHALLOWDOWN
+@steepdown:
+        jmp     STEEPDOWN
+
+; set up the loop counter and error term, return carry set if dy > dx
+OCTANT:
+        lda     DX+1
+        bne     @shallow
+        lda     DX
+        cmp     DY
+        bcs     @shallow
+        lda     DY              ; steep: dy + 1 pixels
+        tax
+        inx
+        lsr     a
+        sta     ERR
+        sec
+        rts
+@shallow:
+        lda     DX+1            ; shallow: dx more pixels after the first
+        sta     COUNT
+        lsr     a
+        sta     ERR+1
+        lda     DX
+        tax
+        ror     a
+        sta     ERR
+        clc
+        rts
+
+SHALLOWDOWN:
+        shallow 0
+SHALLOWUP:
+        shallow 1
+STEEPDOWN:
+        steep   0
+STEEPUP:
+        steep   1
+
+LINEDONE:
+        pla
+        sta     $01
+        plp
+        rts
+
+; BAR: fill the rectangle X1/Y1 to X2/Y2 (sorted and in range)
+
+BAR:
+        lda     X1
+        and     #$07
+        tax
+        lda     LEFTMASK,x
+        sta     MASK
+        lda     X2
+        and     #$07
+        tax
+        lda     RIGHTMASK,x
+        sta     PIXEL
+        lda     X2+1            ; bytes from the left to the right byte
+        lsr     a
+        lda     X2
+        ror     a
+        lsr     a
+        lsr     a
+        sta     COUNT
+        lda     X1+1
+        lsr     a
+        lda     X1
+        ror     a
+        lsr     a
+        lsr     a
+        eor     #$FF
+        sec
+        adc     COUNT
+        sta     COUNT
+        bne     @wide
+        lda     MASK            ; left and right in one byte
+        and     PIXEL
+        sta     MASK
+@wide:  php
+        sei
+        lda     $01
+        pha
+        lda     #$35
+        sta     $01
+@row:   jsr     CALC
+        flush
+        ldx     COUNT
+        beq     @next
+        dex
+        beq     @right
+@middle:
+        lda     POINT
+        clc
+        adc     #$08
+        sta     POINT
+        bcc     :+
+        inc     POINT+1
+:       lda     BITMASK
+        sta     (POINT),y
+        dex
+        bne     @middle
+@right: lda     POINT
+        clc
+        adc     #$08
+        sta     POINT
+        bcc     :+
+        inc     POINT+1
+:       lda     (POINT),y
+        eor     BITMASK
+        and     PIXEL
+        eor     (POINT),y
+        sta     (POINT),y
+@next:  lda     Y1
+        cmp     Y2
+        beq     @done
+        inc     Y1
+        jmp     @row
+@done:  pla
+        sta     $01
+        plp
+        rts
+
+; TEXTSTYLE, OUTTEXT: no bitmap font, the TGI kernel draws vector fonts
+
+TEXTSTYLE:
+OUTTEXT:
+        rts
+
+; CALC: POINT = cell row address of X1/Y1, y = row in the cell, x = x & 7
+
+CALC:
+        ldx     Y1
+        lda     X1
+        and     #$F8
+        clc
+        adc     ROWLO,x
+        sta     POINT
+        lda     ROWHI,x
+        adc     X1+1
+        sta     POINT+1
+        txa
+        and     #$07
+        tay
+        lda     X1
+        and     #$07
+        tax
+        rts
+
+.endif